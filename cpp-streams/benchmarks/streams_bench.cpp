@@ -0,0 +1,855 @@
+#include "streams.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#endif
+
+/*
+	Every case runs the same work three ways: through a stream pipeline, as a hand-written
+	loop and with std::ranges. The time_per_element counter divides the time of an iteration
+	by the number of source elements, so the abstraction cost of a pipeline is its
+	time_per_element minus the one of the loop, and can be compared across sizes and runs
+
+	Sizes go from 1K to STREAMS_BENCH_MAX_SIZE elements, which is set by CMake
+*/
+
+#if !defined(STREAMS_BENCH_MAX_SIZE)
+#define STREAMS_BENCH_MAX_SIZE 1048576
+#endif
+
+constexpr int64_t MinSize = 1 << 10;
+constexpr int64_t MaxSize = STREAMS_BENCH_MAX_SIZE;
+
+// ===> ELEMENT TYPES <===
+
+/*
+	Record of 64 bytes, about the size of a cache line
+*/
+struct Record
+{
+	uint32_t m_Key;
+	uint32_t m_Payload[15];
+
+	bool operator==(const Record& other) const
+	{
+		return m_Key == other.m_Key;
+	}
+
+	bool operator<(const Record& other) const
+	{
+		return m_Key < other.m_Key;
+	}
+};
+
+static_assert(sizeof(Record) == 64, "Record must be 64 bytes long");
+
+template<>
+struct std::hash<Record>
+{
+	size_t operator()(const Record& record) const
+	{
+		return std::hash<uint32_t>()(record.m_Key);
+	}
+};
+
+/*
+	How each element type is built from a key, and the cheap operations the cases apply to it
+*/
+template<typename T>
+struct Element;
+
+template<>
+struct Element<int>
+{
+	static constexpr const char* Name = "int";
+
+	static int make(uint32_t key)
+	{
+		return static_cast<int>(key);
+	}
+
+	static uint32_t key(int value)
+	{
+		return static_cast<uint32_t>(value);
+	}
+
+	static int transform(int value)
+	{
+		return value * 3 + 1;
+	}
+};
+
+template<>
+struct Element<float>
+{
+	static constexpr const char* Name = "float";
+
+	static float make(uint32_t key)
+	{
+		return static_cast<float>(key);
+	}
+
+	static uint32_t key(float value)
+	{
+		return static_cast<uint32_t>(value);
+	}
+
+	static float transform(float value)
+	{
+		return value * 1.5f + 1.0f;
+	}
+};
+
+template<>
+struct Element<std::string>
+{
+	static constexpr const char* Name = "string";
+
+	static std::string make(uint32_t key)
+	{
+		return "Number = " + std::to_string(key);
+	}
+
+	static uint32_t key(const std::string& value)
+	{
+		return static_cast<uint32_t>(value.back() - '0');
+	}
+
+	static size_t transform(const std::string& value)
+	{
+		return value.size();
+	}
+};
+
+template<>
+struct Element<Record>
+{
+	static constexpr const char* Name = "record64";
+
+	static Record make(uint32_t key)
+	{
+		Record record{};
+		record.m_Key = key;
+		return record;
+	}
+
+	static uint32_t key(const Record& value)
+	{
+		return value.m_Key;
+	}
+
+	static uint32_t transform(const Record& value)
+	{
+		return value.m_Key * 3 + value.m_Payload[0];
+	}
+};
+
+/*
+	size elements with random keys below size / 2, so about half of them are repeated
+	and the predicate of the cases, an even key, is not predictable
+*/
+template<typename T>
+std::vector<T> makeData(size_t size)
+{
+	std::mt19937 random(42);
+	std::uniform_int_distribution<uint32_t> keys(0, static_cast<uint32_t>(std::max<size_t>(size / 2, 1) - 1));
+
+	std::vector<T> data;
+	data.reserve(size);
+
+	for(size_t i = 0;i < size;++i)
+	{
+		data.push_back(Element<T>::make(keys(random)));
+	}
+
+	return data;
+}
+
+template<typename T>
+bool isEven(const T& value)
+{
+	return Element<T>::key(value) % 2 == 0;
+}
+
+template<typename T>
+bool isMissing(const T& value)
+{
+	return Element<T>::key(value) == UINT32_MAX;
+}
+
+template<typename T>
+auto transform(const T& value)
+{
+	return Element<T>::transform(value);
+}
+
+template<typename T>
+void consume(const T& value)
+{
+	benchmark::DoNotOptimize(value);
+}
+
+template<typename T>
+std::string toString(const T& value)
+{
+	return "Number = " + std::to_string(Element<T>::key(value));
+}
+
+// ===> CASES <===
+
+/*
+	Each case provides streams(data), loop(data) and ranges(data), doing the same work on data
+*/
+
+struct Filter
+{
+	static constexpr const char* Name = "filter";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		stream::of(data).filter(isEven<T>).forEach(consume<T>);
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		for(const T& value : data)
+		{
+			if(isEven(value))
+			{
+				consume(value);
+			}
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		for(const T& value : data | std::views::filter(isEven<T>))
+		{
+			consume(value);
+		}
+	}
+#endif
+};
+
+struct Map
+{
+	static constexpr const char* Name = "map";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		stream::of(data).map(transform<T>).forEach([](auto value) { consume(value); });
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		for(const T& value : data)
+		{
+			consume(transform(value));
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		for(auto value : data | std::views::transform(transform<T>))
+		{
+			consume(value);
+		}
+	}
+#endif
+};
+
+/*
+	Expands each element into the FlatMapSize keys following its own, as an inner stream
+*/
+struct FlatMap
+{
+	static constexpr const char* Name = "flatMap";
+	static constexpr uint32_t FlatMapSize = 4;
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		stream::of(data).flatMap([](const T& value)
+		{
+			const uint32_t key = Element<T>::key(value);
+			return stream::range(key, key + FlatMapSize);
+		}).forEach([](uint32_t key) { consume(key); });
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		for(const T& value : data)
+		{
+			const uint32_t key = Element<T>::key(value);
+			for(uint32_t i = key;i < key + FlatMapSize;++i)
+			{
+				consume(i);
+			}
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		auto keys = [](const T& value)
+		{
+			const uint32_t key = Element<T>::key(value);
+			return std::views::iota(key, key + FlatMapSize);
+		};
+
+		for(uint32_t key : data | std::views::transform(keys) | std::views::join)
+		{
+			consume(key);
+		}
+	}
+#endif
+};
+
+struct Distinct
+{
+	static constexpr const char* Name = "distinct";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		stream::of(data).distinct().forEach(consume<T>);
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		std::unordered_set<T> seen;
+
+		for(const T& value : data)
+		{
+			if(seen.insert(value).second)
+			{
+				consume(value);
+			}
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		std::unordered_set<T> seen;
+
+		for(const T& value : data | std::views::filter([&](const T& value) { return seen.insert(value).second; }))
+		{
+			consume(value);
+		}
+	}
+#endif
+};
+
+struct Limit
+{
+	static constexpr const char* Name = "limit";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		stream::of(data).limit(data.size() / 2).forEach(consume<T>);
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		for(size_t i = 0;i < data.size() / 2;++i)
+		{
+			consume(data[i]);
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		for(const T& value : data | std::views::take(data.size() / 2))
+		{
+			consume(value);
+		}
+	}
+#endif
+};
+
+struct Skip
+{
+	static constexpr const char* Name = "skip";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		stream::of(data).skip(data.size() / 2).forEach(consume<T>);
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		for(size_t i = data.size() / 2;i < data.size();++i)
+		{
+			consume(data[i]);
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		for(const T& value : data | std::views::drop(data.size() / 2))
+		{
+			consume(value);
+		}
+	}
+#endif
+};
+
+/*
+	Counts the elements passing a filter, since counting a SIZED stream does not traverse it
+*/
+struct Count
+{
+	static constexpr const char* Name = "count";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		consume(stream::of(data).filter(isEven<T>).count());
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		size_t count = 0;
+
+		for(const T& value : data)
+		{
+			count += isEven(value) ? 1 : 0;
+		}
+
+		consume(count);
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		consume(std::ranges::count_if(data, isEven<T>));
+	}
+#endif
+};
+
+struct Collect
+{
+	static constexpr const char* Name = "collect";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		consume(stream::of(data).template collect<std::vector<T>>());
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		std::vector<T> result;
+		result.reserve(data.size());
+
+		for(const T& value : data)
+		{
+			result.push_back(value);
+		}
+
+		consume(result);
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		std::vector<T> result;
+		result.reserve(data.size());
+		std::ranges::copy(data, std::back_inserter(result));
+		consume(result);
+	}
+#endif
+};
+
+/*
+	Sums the transformed elements
+*/
+struct Reduce
+{
+	static constexpr const char* Name = "reduce";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		using R = decltype(transform(data[0]));
+		consume(stream::of(data).map(transform<T>).reduce(R(), std::plus<R>()));
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		decltype(transform(data[0])) sum{};
+
+		for(const T& value : data)
+		{
+			sum += transform(value);
+		}
+
+		consume(sum);
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		using R = decltype(transform(data[0]));
+		auto transformed = data | std::views::transform(transform<T>);
+		consume(std::accumulate(transformed.begin(), transformed.end(), R()));
+	}
+#endif
+};
+
+struct Min
+{
+	static constexpr const char* Name = "min";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		consume(stream::of(data).min());
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		const T* min = &data[0];
+
+		for(const T& value : data)
+		{
+			if(value < *min)
+			{
+				min = &value;
+			}
+		}
+
+		consume(*min);
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		consume(*std::ranges::min_element(data, [](const T& a, const T& b) { return a < b; }));
+	}
+#endif
+};
+
+/*
+	Count, minimum, maximum, mean and variance of the keys in a single pass
+*/
+struct Statistics
+{
+	static constexpr const char* Name = "statistics";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		consume(stream::of(data).map([](const T& value) { return Element<T>::key(value); }).summaryStatistics());
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		size_t count = 0;
+		uint32_t min = UINT32_MAX;
+		uint32_t max = 0;
+		double mean = 0;
+		double m2 = 0;
+
+		for(const T& value : data)
+		{
+			const uint32_t key = Element<T>::key(value);
+			min = std::min(min, key);
+			max = std::max(max, key);
+
+			const double delta = key - mean;
+			mean += delta / static_cast<double>(++count);
+			m2 += delta * (key - mean);
+		}
+
+		consume(min);
+		consume(max);
+		consume(m2 / static_cast<double>(count));
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		auto keys = data | std::views::transform([](const T& value) { return Element<T>::key(value); });
+
+		const auto [min, max] = std::ranges::minmax(keys);
+		const double mean = std::accumulate(keys.begin(), keys.end(), 0.0) / static_cast<double>(data.size());
+		const double m2 = std::accumulate(keys.begin(), keys.end(), 0.0, [mean](double m2, uint32_t key) { return m2 + (key - mean) * (key - mean); });
+
+		consume(min);
+		consume(max);
+		consume(m2 / static_cast<double>(data.size()));
+	}
+#endif
+};
+
+/*
+	No element matches, so every element is tested
+*/
+struct AnyMatch
+{
+	static constexpr const char* Name = "anyMatch";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		consume(stream::of(data).anyMatch(isMissing<T>));
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		bool found = false;
+
+		for(const T& value : data)
+		{
+			if(isMissing(value))
+			{
+				found = true;
+				break;
+			}
+		}
+
+		consume(found);
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		consume(std::ranges::any_of(data, isMissing<T>));
+	}
+#endif
+};
+
+/*
+	Finds the first element after a filter, which short-circuits the traversal
+*/
+struct FindFirst
+{
+	static constexpr const char* Name = "findFirst";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		consume(stream::of(data).filter(isMissing<T>).findFirst());
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		for(const T& value : data)
+		{
+			if(isMissing(value))
+			{
+				consume(value);
+				return;
+			}
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		auto found = std::ranges::find_if(data, isMissing<T>);
+		consume(found != data.end());
+	}
+#endif
+};
+
+struct ForEach
+{
+	static constexpr const char* Name = "forEach";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		stream::of(data).forEach(consume<T>);
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		for(const T& value : data)
+		{
+			consume(value);
+		}
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		std::ranges::for_each(data, consume<T>);
+	}
+#endif
+};
+
+/*
+	The filter -> distinct -> map -> collect pipeline of examples/main.cpp
+*/
+struct Pipeline
+{
+	static constexpr const char* Name = "pipeline";
+
+	template<typename T>
+	static void streams(const std::vector<T>& data)
+	{
+		consume(stream::of(data)
+			.filter(isEven<T>)
+			.distinct()
+			.map(toString<T>)
+			.template collect<std::vector<std::string>>());
+	}
+
+	template<typename T>
+	static void loop(const std::vector<T>& data)
+	{
+		std::unordered_set<T> seen;
+		std::vector<std::string> result;
+
+		for(const T& value : data)
+		{
+			if(isEven(value) && seen.insert(value).second)
+			{
+				result.push_back(toString(value));
+			}
+		}
+
+		consume(result);
+	}
+
+#if defined(__cpp_lib_ranges)
+	template<typename T>
+	static void ranges(const std::vector<T>& data)
+	{
+		std::unordered_set<T> seen;
+		std::vector<std::string> result;
+
+		auto pipeline = data
+			| std::views::filter(isEven<T>)
+			| std::views::filter([&](const T& value) { return seen.insert(value).second; })
+			| std::views::transform(toString<T>);
+
+		std::ranges::copy(pipeline, std::back_inserter(result));
+		consume(result);
+	}
+#endif
+};
+
+// ===> REGISTRATION <===
+
+template<typename T, typename Run>
+void registerBenchmark(const std::string& name, Run run)
+{
+	benchmark::RegisterBenchmark(name.c_str(), [run](benchmark::State& state)
+	{
+		const size_t size = static_cast<size_t>(state.range(0));
+		const std::vector<T> data = makeData<T>(size);
+
+		for(auto _ : state)
+		{
+			run(data);
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+		state.counters["time_per_element"] = benchmark::Counter(static_cast<double>(size),
+			benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+	})->RangeMultiplier(8)->Range(MinSize, MaxSize);
+}
+
+/*
+	Registers the benchmarks <case>/<type>/<streams|loop|ranges>/<size>
+*/
+template<typename Case, typename T>
+void registerType()
+{
+	const std::string name = std::string(Case::Name) + "/" + Element<T>::Name + "/";
+
+	registerBenchmark<T>(name + "streams", [](const std::vector<T>& data) { Case::streams(data); });
+	registerBenchmark<T>(name + "loop", [](const std::vector<T>& data) { Case::loop(data); });
+#if defined(__cpp_lib_ranges)
+	registerBenchmark<T>(name + "ranges", [](const std::vector<T>& data) { Case::ranges(data); });
+#endif
+}
+
+template<typename Case>
+void registerCase()
+{
+	registerType<Case, int>();
+	registerType<Case, float>();
+	registerType<Case, std::string>();
+	registerType<Case, Record>();
+}
+
+int main(int argc, char** argv)
+{
+	registerCase<Filter>();
+	registerCase<Map>();
+	registerCase<FlatMap>();
+	registerCase<Distinct>();
+	registerCase<Limit>();
+	registerCase<Skip>();
+	registerCase<Count>();
+	registerCase<Collect>();
+	registerCase<Reduce>();
+	registerCase<Min>();
+	registerCase<Statistics>();
+	registerCase<AnyMatch>();
+	registerCase<FindFirst>();
+	registerCase<ForEach>();
+	registerCase<Pipeline>();
+
+	benchmark::Initialize(&argc, argv);
+	if(benchmark::ReportUnrecognizedArguments(argc, argv))
+	{
+		return 1;
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
@@ -56,11 +56,11 @@ struct MapCollector
 	using ContainerType = Container;
 
 	Container m_Container;
+	size_t m_Index = 0;
 
 	void insert(const T& element)
 	{
-		static size_t index = 0;
-		m_Container[index++] = element;
+		m_Container[m_Index++] = element;
 	}
 
 	ContainerType operator*()
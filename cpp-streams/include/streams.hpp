@@ -1,8 +1,72 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
 #include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <unordered_set>
+#include <vector>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#if !defined(STREAM_NO_SIMD) && __has_include(<experimental/simd>)
+#include <experimental/simd>
+#if defined(__cpp_lib_experimental_parallel_simd)
+#define STREAM_HAS_SIMD
+#endif
+#endif
+
+#if !defined(STREAM_NO_MMAP) && __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STREAM_HAS_MMAP
+#endif
+
+#if !defined(STREAM_NO_COROUTINES) && defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define STREAM_HAS_COROUTINES
+#endif
+
+/*
+	In C++20, the sources over arrays and ranges, filter(), map(), limit() and skip(), and the terminal operations
+	count(), reduce(), min(), max() and collect() into a std::array can be evaluated at compile time, for literal
+	types and functions without std::function, e.g. lambdas:
+
+		constexpr std::array<int, 4> squares = stream::range(0, 4).map([](int i) { return i * i; }).collect<std::array<int, 4>>();
+
+	Evaluated at compile time, the terminal operations pull the elements through the pipeline instead of pushing them
+*/
+#if __cplusplus >= 202002L && defined(__cpp_lib_is_constant_evaluated)
+#define STREAM_CONSTEXPR constexpr
+#define STREAM_HAS_CONSTEXPR
+#else
+#define STREAM_CONSTEXPR
+#endif
 
 
 namespace stream
@@ -11,6 +75,18 @@ namespace stream
 	template<typename T>
 	using Optional = std::optional<T>;
 
+	/*
+		Whether the call is evaluated at compile time, where the terminal operations can't run the push protocol
+	*/
+	constexpr bool isConstantEvaluated()
+	{
+#if defined(STREAM_HAS_CONSTEXPR)
+		return std::is_constant_evaluated();
+#else
+		return false;
+#endif
+	}
+
 	// ===> OPERATION TYPES <===
 
 	template<typename T, typename R>
@@ -34,606 +110,9213 @@ namespace stream
 	template<typename T>
 	using Accumulator = BiFunction<T, T, T>;
 
-// ===============================================================================================================================
-
+	/*
+		Result type of a map operation: R if it was explicitly specified,
+		or the return type of MapFunction when invoked with T otherwise
+	*/
+	template<typename R, typename T, typename MapFunction>
+	using MapResult = std::conditional_t<std::is_void_v<R>, std::decay_t<std::invoke_result_t<MapFunction&, T>>, R>;
 
-	// ===> STREAM TYPES <===
+	/*
+		Predicate of two adjacent filters fused into one stage: Second is only called on the elements passing First
+	*/
+	template<typename First, typename Second>
+	struct Conjunction
+	{
+		First m_First;
+		Second m_Second;
 
+		template<typename E>
+		STREAM_CONSTEXPR bool operator()(const E& element)
+		{
+			return m_First(element) && m_Second(element);
+		}
+	};
 
 	/*
-		Base class for all streams
+		Function of two adjacent maps fused into one stage. The result of First is converted to
+		the Intermediate type of the first map, so Second receives exactly what it did before
+	*/
+	template<typename Intermediate, typename First, typename Second>
+	struct Composition
+	{
+		First m_First;
+		Second m_Second;
 
-		It provides a full interface for all possible operations with
-		streams. Subclasses of this class must implement its pipeline stage
-	
-		==> T: the type of the elements of this stream
-		==> Self: type of this stream object. This will serve as the source for the next stream in the pipeline
+		template<typename E>
+		STREAM_CONSTEXPR decltype(auto) operator()(E&& element)
+		{
+			return m_Second(static_cast<Intermediate>(m_First(std::forward<E>(element))));
+		}
+	};
+
+	/*
+		Strict weak ordering built from a comparator returning a negative value when its first argument is the lesser one
 	*/
-	template<typename T, typename Self>
-	class Stream;
+	template<typename T, typename Compare>
+	struct ComparatorLess
+	{
+		Compare m_Comparator;
 
+		bool operator()(const T& first, const T& second) const
+		{
+			return m_Comparator(first, second) < 0;
+		}
+	};
 
+// ===============================================================================================================================
 
-	/*
-		Stream that supplies elements from a collection of data. Elements
-		provided by this type of stream are not modified
-	
-		==> T: the type of the elements of this stream
-		==> Iterator: the iterator type of the data container
 
-	*/
-	template<typename T, typename Iterator>
-	class SourceStream;
+	// ===> PROFILING <===
+
 
-	
 	/*
-		Stream for filtering operations
+		Per-stage statistics of the pipelines run with profiled(&stats)
 
-		It takes an element from the previous stream and evaluates it.
-		If the condition is true, the element will advance through the pipeline
-		to the next stream. If the condition is returns false, the element is discarded.
-	
+		Each stage counts the elements pushed into it and the time spent in it. Profiling only
+		exists if STREAM_PROFILING is defined: otherwise profiled() does nothing and the report is
+		empty, so the pipelines compile to the same code as without it. Only the push path of the
+		terminal operations is profiled, not the elements pulled one by one, e.g. through an AnyStream
 	*/
-	template<typename T, typename PreviousStream>
-	class FilterStream;
+	class PipelineStats
+	{
+	public:
 
+		/*
+			==> const char* name: the operation of the stage, e.g. "filter", or "terminal" for the terminal operation
+			==> uint64_t elementsIn: the elements pushed into the stage
+			==> uint64_t elementsOut: the elements the stage pushed into the next one
+			==> double selectivity: elementsOut / elementsIn
+			==> uint64_t nanoseconds: the time spent in the stage itself, without the stages after it
+			==> size_t setSize: the unique elements kept by a distinct() stage
+			==> double loadFactor: how full the set of a distinct() stage is
+		*/
+		struct Stage
+		{
+			const char* name = "";
+			uint64_t elementsIn = 0;
+			uint64_t elementsOut = 0;
+			double selectivity = 1.0;
+			uint64_t nanoseconds = 0;
+			size_t setSize = 0;
+			double loadFactor = 0.0;
+		};
+
+		/*
+			Statistics of a stage shared by the sinks of its parallel chunks, which add their own counts once they end
+		*/
+		struct Record
+		{
+			const void* key;
+			const char* name;
+			std::atomic<uint64_t> elementsIn{0};
+			std::atomic<uint64_t> nanoseconds{0};
+			std::atomic<size_t> setSize{0};
+			std::atomic<double> loadFactor{0.0};
+
+			Record(const void* key, const char* name)
+				: key(key), name(name)
+			{
 
-	/*
-		Stream for limiting operations
+			}
+		};
+
+		/*
+			The stages of the profiled pipelines, each in pipeline order and ending with its terminal operation.
+			The time of a stage is measured in the whole stage chain after it, so the time of the next stage is
+			subtracted from it
+		*/
+		std::vector<Stage> report() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
 
-		Consists of the elements in the previous stream truncated to be
-		no longer than MaxSize in length
+			std::vector<Stage> stages;
+			stages.reserve(m_Records.size());
 
-	*/
-	template<typename T, size_t MaxSize, typename PreviousStream>
-	class LimitStream;
+			for(size_t i = 0;i < m_Records.size();++i)
+			{
+				const Record& record = m_Records[i];
+				const bool isTerminal = std::string_view(record.name) == "terminal";
+				const Record* next = isTerminal || i + 1 == m_Records.size() ? nullptr : &m_Records[i + 1];
 
-	/*
-	Stream for skipping operations
+				Stage stage;
+				stage.name = record.name;
+				stage.elementsIn = record.elementsIn.load();
+				stage.elementsOut = next != nullptr ? next->elementsIn.load() : stage.elementsIn;
+				stage.selectivity = stage.elementsIn == 0 ? 1.0 : static_cast<double>(stage.elementsOut) / static_cast<double>(stage.elementsIn);
 
-	Skips the first N elements in the stream
+				const uint64_t nanoseconds = record.nanoseconds.load();
+				const uint64_t nextNanoseconds = next != nullptr ? next->nanoseconds.load() : 0;
+				stage.nanoseconds = nanoseconds > nextNanoseconds ? nanoseconds - nextNanoseconds : 0;
 
-	*/
-	template<typename T, size_t N, typename PreviousStream>
-	class SkipStream;
+				stage.setSize = record.setSize.load();
+				stage.loadFactor = record.loadFactor.load();
 
-	/*
-		Stream for limiting operations
+				stages.push_back(stage);
+			}
 
-		Skips the first N elements in the stream
+			return stages;
+		}
 
-	*/
-	template<typename T, typename PreviousStream>
-	class DistinctStream;
+		void reset()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Records.clear();
+		}
 
-	/*
-	
-		Stream for mapping operations
+		/*
+			The record of the stage identified by key and name, created if needed. Stages build their
+			sinks from the terminal operation back to the source, so new records are put in front
+		*/
+		Record& record(const void* key, const char* name)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
 
-		Maps each incoming element into another
-	
-	*/
-	template<typename T, typename R, typename PreviuosStream>
-	class MapStream;
+			for(Record& record : m_Records)
+			{
+				if(record.key == key && record.name == name)
+				{
+					return record;
+				}
+			}
 
+			return m_Records.emplace_front(key, name);
+		}
 
-#define _STREAM_FRIEND_TYPES_ \
-	template<class _T, class _Iterator> friend class SourceStream;\
-	template<class _T, class _PreviousStream> friend class FilterStream;\
-	template<class _T, size_t _MaxSize, class _PreviousStream> friend class LimitStream;\
-	template<class _T, size_t _N, class _PreviousStream> friend class SkipStream;\
-	template<class _T, class _PreviousStream> friend class DistinctStream;\
-	template<class _T, class _R, class _PreviousStream> friend class MapStream;\
+	private:
+		mutable std::mutex m_Mutex;
+		std::deque<Record> m_Records;
+	};
 
 // ===============================================================================================================================
 
-	// ===> UTILITY FUNCTIONS <===
 
+	// ===> EXECUTORS <===
 
-	/*
-		Creates an empty stream
-	*/
-	template<typename T>
-	SourceStream<T, T*> empty()
-	{
-		return SourceStream<T, T*>(nullptr, nullptr);
-	}
 
 	/*
-		Creates a stream from the given array and the given size
+		Runs the chunks of parallel streams
 
-		==> T* values: the data container
-		==> size_t size: the size of the data collection 
+		Implement this interface to run parallel streams on your own threads
 
 	*/
-	template<typename T>
-	SourceStream<T, T*> of(T* values, size_t size)
+	class Executor
 	{
-		return SourceStream<T, T*>(values, values + size);
-	}
+	public:
 
-	/*
-		Creates a stream from the given container.
-		
-		You may also specify its type and iterator
+		virtual ~Executor() {}
 
-		==> Container& container: the data container
+		/*
+			The number of tasks this executor is able to run at the same time
+		*/
+		virtual size_t concurrency() const = 0;
 
-	*/
-	template<
-		class Container,
-		class T = typename Container::value_type,
-		class Iterator = typename Container::iterator>
-	SourceStream<T, Iterator> of(Container& container)
-	{
-		return SourceStream<T, Iterator>(std::begin(container), std::end(container));
-	}
+		/*
+			Runs task(0), task(1)... task(count - 1), possibly concurrently,
+			and returns once all of them have finished. If any task throws, one
+			of the exceptions is rethrown
 
-	/*
-		Creates a stream containing the elements within the given iterators
+			==> size_t count: the number of tasks
+			==> const Function<size_t, void>& task: the task to run for each index
 
-		==> Iterator begin: the start iterator
-		==> Iterator end: the end iterator
+		*/
+		virtual void parallelFor(size_t count, const Function<size_t, void>& task) = 0;
+	};
+
+
+	/*
+		Thread pool where each worker owns a queue of tasks. Workers take tasks from the
+		back of their own queue, and steal from the front of other queues when they run out.
+		The thread calling parallelFor() also runs tasks while it waits, so nested parallel
+		operations do not deadlock
 
 	*/
-	template<class T, class Iterator>
-	SourceStream<T, Iterator> of(Iterator begin, Iterator end)
+	class WorkStealingExecutor : public Executor
 	{
-		return SourceStream<T, Iterator>(std::move(begin), std::move(end));
-	}
-
-	
+	public:
 
+		/*
+			==> size_t threadCount: the number of threads running tasks, including the calling thread
+		*/
+		explicit WorkStealingExecutor(size_t threadCount = std::thread::hardware_concurrency())
+		{
+			const size_t workerCount = threadCount > 1 ? threadCount - 1 : 0;
 
-// ===============================================================================================================================
+			for(size_t i = 0;i < workerCount;++i)
+			{
+				m_Queues.push_back(std::make_unique<Queue>());
+			}
 
+			for(size_t i = 0;i < workerCount;++i)
+			{
+				m_Workers.emplace_back([this, i]() { work(i); });
+			}
+		}
 
-	// ===> IMPLEMENTATIONS <===
+		WorkStealingExecutor(const WorkStealingExecutor&) = delete;
 
-	template<typename T, typename Self>
-	class Stream
-	{
-		_STREAM_FRIEND_TYPES_
-	public:
+		WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
 
-		virtual ~Stream() {}
+		~WorkStealingExecutor()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_SleepMutex);
+				m_Stopping = true;
+			}
 
-		// ===> Intermediate operations <===
+			m_WakeUp.notify_all();
 
-		DistinctStream<T, Self> distinct()
-		{
-			return DistinctStream<T, Self>(static_cast<Self*>(this));
+			for(std::thread& worker : m_Workers)
+			{
+				worker.join();
+			}
 		}
 
-		FilterStream<T, Self> filter(Predicate<T> condition)
+		size_t concurrency() const override
 		{
-			return FilterStream<T, Self>(static_cast<Self*>(this), condition);
+			return m_Workers.size() + 1;
 		}
 
-		template<size_t MaxSize>
-		LimitStream<T, MaxSize, Self> limit()
+		void parallelFor(size_t count, const Function<size_t, void>& task) override
 		{
-			return LimitStream<T, MaxSize, Self>(static_cast<Self*>(this));
+			if(m_Queues.empty() || count <= 1)
+			{
+				for(size_t i = 0;i < count;++i)
+				{
+					task(i);
+				}
+				return;
+			}
+
+			Batch batch;
+			batch.m_Pending = count;
+
+			for(size_t i = 0;i < count;++i)
+			{
+				Queue& queue = *m_Queues[i % m_Queues.size()];
+				std::lock_guard<std::mutex> lock(queue.m_Mutex);
+				queue.m_Tasks.push_back(Task{&task, i, &batch});
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_SleepMutex);
+				m_QueuedTasks += count;
+			}
+
+			m_WakeUp.notify_all();
+
+			Task next;
+			while(batch.m_Pending.load() > 0 && steal(0, next))
+			{
+				run(next);
+			}
+
+			std::unique_lock<std::mutex> lock(batch.m_Mutex);
+			batch.m_Done.wait(lock, [&]() { return batch.m_Pending.load() == 0; });
+
+			if(batch.m_Error)
+			{
+				std::rethrow_exception(batch.m_Error);
+			}
 		}
 
-		template<typename R>
-		MapStream<T, R, Self> map(Function<T, R> mapFunction)
+	private:
+
+		struct Batch
 		{
-			return MapStream<T, R, Self>(static_cast<Self*>(this), mapFunction);
-		}
+			std::atomic<size_t> m_Pending{0};
+			std::mutex m_Mutex;
+			std::condition_variable m_Done;
+			std::exception_ptr m_Error;
+		};
 
-		template<size_t N>
-		SkipStream<T, N, Self> skip()
+		struct Task
 		{
-			return SkipStream<T, N, Self>(static_cast<Self*>(this));
-		}
+			const Function<size_t, void>* m_Function = nullptr;
+			size_t m_Index = 0;
+			Batch* m_Batch = nullptr;
+		};
 
-		// ===> Terminal operations <===
+		struct Queue
+		{
+			std::mutex m_Mutex;
+			std::deque<Task> m_Tasks;
+		};
 
-		bool allMatch(Predicate<T> condition)
+		void work(size_t index)
 		{
-			while(hasRemaining())
+			Task next;
+
+			while(true)
 			{
-				if(!condition(next()))
+				if(popLocal(index, next) || steal(index + 1, next))
 				{
-					return false;
+					run(next);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(m_SleepMutex);
+				m_WakeUp.wait(lock, [&]() { return m_Stopping || m_QueuedTasks > 0; });
+
+				if(m_Stopping && m_QueuedTasks == 0)
+				{
+					return;
 				}
 			}
+		}
+
+		bool popLocal(size_t index, Task& task)
+		{
+			Queue& queue = *m_Queues[index];
+			std::lock_guard<std::mutex> lock(queue.m_Mutex);
+
+			if(queue.m_Tasks.empty())
+			{
+				return false;
+			}
+
+			task = queue.m_Tasks.back();
+			queue.m_Tasks.pop_back();
+			taken();
+
 			return true;
 		}
 
-		bool anyMatch(Predicate<T> condition)
+		bool steal(size_t first, Task& task)
 		{
-			while(hasRemaining())
+			for(size_t i = 0;i < m_Queues.size();++i)
 			{
-				if(condition(next()))
+				Queue& queue = *m_Queues[(first + i) % m_Queues.size()];
+				std::lock_guard<std::mutex> lock(queue.m_Mutex);
+
+				if(!queue.m_Tasks.empty())
 				{
+					task = queue.m_Tasks.front();
+					queue.m_Tasks.pop_front();
+					taken();
+
 					return true;
 				}
 			}
+
 			return false;
 		}
 
-		template<typename Container>
-		Container collect()
+		void taken()
 		{
-			Container container;
-			return std::move(collect(container));
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			--m_QueuedTasks;
 		}
 
-		template<typename Container>
-		Container& collect(Container& container)
+		void run(const Task& task)
 		{
-			while(hasRemaining())
+			Batch& batch = *task.m_Batch;
+
+			try
+			{
+				(*task.m_Function)(task.m_Index);
+			}
+			catch(...)
 			{
-				container.insert(std::end(container), next());
+				std::lock_guard<std::mutex> lock(batch.m_Mutex);
+				if(!batch.m_Error)
+				{
+					batch.m_Error = std::current_exception();
+				}
 			}
 
-			return container;
+			// The batch lives in the stack of the thread waiting for it, so it must not be
+			// touched after the last task releases its mutex
+			std::lock_guard<std::mutex> lock(batch.m_Mutex);
+			if(--batch.m_Pending == 0)
+			{
+				batch.m_Done.notify_all();
+			}
 		}
 
-		template<typename Collector, typename Container = typename Collector::ContainerType>
-		Container collect(Collector collector)
+	private:
+		std::vector<std::unique_ptr<Queue>> m_Queues;
+		std::vector<std::thread> m_Workers;
+		std::mutex m_SleepMutex;
+		std::condition_variable m_WakeUp;
+		size_t m_QueuedTasks = 0;
+		bool m_Stopping = false;
+	};
+
+
+	/*
+		The executor used by parallel streams unless another one is specified.
+		It runs as many threads as the hardware supports
+	*/
+	inline Executor& defaultExecutor()
+	{
+		static WorkStealingExecutor executor;
+		return executor;
+	}
+
+
+	/*
+		How the terminal operation of a pipeline is executed. It is stored
+		in the source stream and shared by the whole pipeline
+
+		==> Executor* executor: runs the pipeline in parallel if not null
+		==> bool ordered: whether the encounter order of the source must be respected
+		==> bool reassociate: whether floating-point reductions may be evaluated in any order
+		==> size_t blockSize: the number of elements pushed at once through the pipeline, or 0 to push them one by one
+		==> std::pmr::memory_resource* resource: where the stages allocate their storage, or null for the default resource
+
+	*/
+	struct ExecutionOptions
+	{
+		Executor* executor = nullptr;
+		bool ordered = true;
+		bool reassociate = false;
+		size_t blockSize = 0;
+		std::pmr::memory_resource* resource = nullptr;
+		PipelineStats* stats = nullptr;
+	};
+
+// ===============================================================================================================================
+
+
+	// ===> BLOCKS <===
+
+
+	/*
+		A block of elements pushed at once through the pipeline in batched mode
+
+		Stages working on whole blocks don't copy the selected elements into new storage:
+		filters only write the indices of the elements that pass into a selection vector
+
+		==> E: the type of the values of the block
+		==> Movable: whether the values are owned by the pipeline, so they may be moved out
+
+	*/
+	template<typename E, bool Movable>
+	struct Block
+	{
+		// The values of the block
+		E* values = nullptr;
+		// The indices of the selected values in ascending order, or nullptr if every value is selected
+		const uint32_t* selection = nullptr;
+		// The number of selected values
+		size_t size = 0;
+
+		E& operator[](size_t index) const
 		{
-			while(hasRemaining())
+			return selection == nullptr ? values[index] : values[selection[index]];
+		}
+
+		/*
+			The selected value at the given index, as an rvalue if it may be moved
+		*/
+		decltype(auto) forward(size_t index) const
+		{
+			if constexpr(Movable)
+			{
+				return std::move((*this)[index]);
+			}
+			else
 			{
-				collector.insert(next());
+				return (*this)[index];
 			}
+		}
+	};
 
-			return *collector;
+	/*
+		Whether Iterator points to elements stored contiguously in memory
+	*/
+	template<typename T, typename Iterator>
+	constexpr bool isContiguous()
+	{
+		using Value = std::remove_cv_t<typename std::iterator_traits<Iterator>::value_type>;
+
+		if constexpr(std::is_pointer_v<Iterator>)
+		{
+			return true;
+		}
+		else if constexpr(std::is_same_v<Value, bool>)
+		{
+			return false;
+		}
+#if __cplusplus >= 202002L
+		else if constexpr(std::contiguous_iterator<Iterator>)
+		{
+			return true;
+		}
+#endif
+		else
+		{
+			return std::is_same_v<Iterator, typename std::vector<Value>::iterator>
+				|| std::is_same_v<Iterator, typename std::vector<Value>::const_iterator>;
+		}
+	}
+
+	/*
+		View of contiguous elements, like the windows of chunk() and sliding().
+		It is std::span<const T> where the standard library provides it
+	*/
+#if defined(__cpp_lib_span)
+	template<typename T>
+	using Span = std::span<const T>;
+#else
+	template<typename T>
+	class Span
+	{
+	public:
+		using element_type = const T;
+		using value_type = std::remove_cv_t<T>;
+		using size_type = size_t;
+		using iterator = const T*;
+
+		constexpr Span() = default;
+
+		constexpr Span(const T* data, size_t size)
+			: m_Data(data), m_Size(size)
+		{
+
+		}
+
+		constexpr const T* data() const
+		{
+			return m_Data;
+		}
+
+		constexpr size_t size() const
+		{
+			return m_Size;
+		}
+
+		constexpr bool empty() const
+		{
+			return m_Size == 0;
+		}
+
+		constexpr const T& operator[](size_t index) const
+		{
+			return m_Data[index];
+		}
+
+		constexpr const T& front() const
+		{
+			return m_Data[0];
+		}
+
+		constexpr const T& back() const
+		{
+			return m_Data[m_Size - 1];
+		}
+
+		constexpr const T* begin() const
+		{
+			return m_Data;
+		}
+
+		constexpr const T* end() const
+		{
+			return m_Data + m_Size;
+		}
+
+	private:
+		const T* m_Data = nullptr;
+		size_t m_Size = 0;
+	};
+#endif
+
+	/*
+		Block size used by batched pipelines unless another one is specified
+	*/
+	constexpr size_t DefaultBlockSize = 1024;
+
+
+	template<typename Sink, typename Block, typename = void>
+	struct AcceptsBlocks : std::false_type
+	{
+
+	};
+
+	template<typename Sink, typename Block>
+	struct AcceptsBlocks<Sink, Block, std::void_t<decltype(std::declval<Sink&>().acceptBlock(std::declval<const Block&>()))>> : std::true_type
+	{
+
+	};
+
+	/*
+		Pushes a block into sink. Sinks without an acceptBlock(const Block&) method
+		receive the selected elements one by one. Returns false if sink wants no more elements
+	*/
+	template<typename Sink, typename E, bool Movable>
+	bool pushBlock(Sink& sink, const Block<E, Movable>& block)
+	{
+		if constexpr(AcceptsBlocks<Sink, Block<E, Movable>>::value)
+		{
+			return sink.acceptBlock(block);
+		}
+		else
+		{
+			for(size_t i = 0;i < block.size;++i)
+			{
+				if(!sink.accept(block.forward(i)))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	}
+
+// ===============================================================================================================================
+
+
+	// ===> SPLITERATORS <===
+
+
+	/*
+		Properties of the elements supplied by a source, and preserved or not by each stage of the pipeline
+
+		==> SIZED: the exact number of elements is known before traversing them
+		==> ORDERED: the elements have a defined encounter order
+		==> DISTINCT: there are no two equal elements
+		==> SORTED: the elements are sorted, so equal elements are adjacent
+
+	*/
+	enum Characteristics : unsigned
+	{
+		SIZED = 1 << 0,
+		ORDERED = 1 << 1,
+		DISTINCT = 1 << 2,
+		SORTED = 1 << 3
+	};
+
+	/*
+		Size of a source or stage when it is not known
+	*/
+	constexpr size_t UnknownSize = std::numeric_limits<size_t>::max();
+
+
+	/*
+		Whether Iterator provides middle(end), returning an iterator roughly halfway to end in constant time
+	*/
+	template<typename Iterator, typename = void>
+	struct HasMiddle : std::false_type
+	{
+
+	};
+
+	template<typename Iterator>
+	struct HasMiddle<Iterator, std::void_t<decltype(std::declval<const Iterator&>().middle(std::declval<const Iterator&>()))>> : std::true_type
+	{
+
+	};
+
+
+	/*
+		Traverses and partitions the elements within a pair of iterators
+
+		Random-access iterators, including pointers, are split in half in constant time.
+		Forward iterators providing middle(end) are split there, those of a known size are
+		split in half by walking to the middle, and those of an unknown size are split into
+		batches of increasing size. Input iterators are never split
+
+		==> T: the type of the elements
+		==> Iterator: the iterator type of the data container
+
+	*/
+	template<typename T, typename Iterator>
+	class Spliterator
+	{
+	public:
+
+		/*
+			==> Iterator begin: the start iterator
+			==> Iterator end: the end iterator
+			==> unsigned characteristics: the Characteristics of the elements
+			==> size_t size: the number of elements, if known. Random-access iterators compute it themselves
+
+		*/
+		STREAM_CONSTEXPR Spliterator(Iterator begin, Iterator end, unsigned characteristics = ORDERED, size_t size = UnknownSize)
+			: m_Current(std::move(begin)), m_End(std::move(end)), m_Characteristics(characteristics), m_Size(size)
+		{
+			if constexpr(IsRandomAccess)
+			{
+				m_Characteristics |= SIZED;
+			}
+			else if(m_Size != UnknownSize)
+			{
+				m_Characteristics |= SIZED;
+			}
+			else
+			{
+				m_Characteristics &= ~SIZED;
+			}
+		}
+
+		/*
+			Splits off a prefix of the remaining elements. This spliterator keeps the rest of them.
+			Returns nothing if there are too few elements or the iterator cannot be split
+		*/
+		Optional<Spliterator> trySplit()
+		{
+			if constexpr(IsRandomAccess)
+			{
+				const size_t size = estimateSize();
+				if(size < 2)
+				{
+					return {};
+				}
+
+				Iterator middle = m_Current + static_cast<Difference>(size / 2);
+				Spliterator prefix(m_Current, middle, m_Characteristics);
+				m_Current = middle;
+
+				return prefix;
+			}
+			else if constexpr(IsForward && HasMiddle<Iterator>::value)
+			{
+				Iterator middle = m_Current.middle(m_End);
+				if(middle == m_Current || middle == m_End)
+				{
+					return {};
+				}
+
+				Spliterator prefix(m_Current, middle, m_Characteristics);
+				m_Current = middle;
+
+				return prefix;
+			}
+			else if constexpr(IsForward)
+			{
+				if(m_Size != UnknownSize)
+				{
+					if(m_Size < 2)
+					{
+						return {};
+					}
+
+					const size_t prefixSize = m_Size / 2;
+					Iterator middle = std::next(m_Current, static_cast<Difference>(prefixSize));
+					Spliterator prefix(m_Current, middle, m_Characteristics, prefixSize);
+					m_Current = middle;
+					m_Size -= prefixSize;
+
+					return prefix;
+				}
+
+				Iterator middle = m_Current;
+				size_t prefixSize = 0;
+
+				while(prefixSize < m_BatchSize && middle != m_End)
+				{
+					++middle;
+					++prefixSize;
+				}
+
+				if(middle == m_End)
+				{
+					return {};
+				}
+
+				Spliterator prefix(m_Current, middle, m_Characteristics, prefixSize);
+				m_Current = middle;
+				m_BatchSize += BatchSizeIncrement;
+
+				return prefix;
+			}
+			else
+			{
+				return {};
+			}
+		}
+
+		/*
+			The number of remaining elements, or UnknownSize. For forward
+			iterators, it is only exact until the elements are traversed
+		*/
+		STREAM_CONSTEXPR size_t estimateSize() const
+		{
+			if constexpr(IsRandomAccess)
+			{
+				return static_cast<size_t>(m_End - m_Current);
+			}
+			else
+			{
+				return m_Size;
+			}
+		}
+
+		STREAM_CONSTEXPR unsigned characteristics() const
+		{
+			return m_Characteristics;
+		}
+
+		STREAM_CONSTEXPR bool hasCharacteristics(unsigned characteristics) const
+		{
+			return (m_Characteristics & characteristics) == characteristics;
+		}
+
+		STREAM_CONSTEXPR bool hasRemaining() const
+		{
+			return m_Current != m_End;
+		}
+
+		STREAM_CONSTEXPR Iterator& current()
+		{
+			return m_Current;
+		}
+
+		/*
+			Pushes every remaining element into sink, until sink.accept() returns false
+		*/
+		template<typename Sink>
+		void forEachRemaining(Sink& sink)
+		{
+			while(m_Current != m_End)
+			{
+				const bool wantsMore = sink.accept(*m_Current);
+				++m_Current;
+
+				if(!wantsMore)
+				{
+					return;
+				}
+			}
+		}
+
+		/*
+			Pushes every remaining element into sink in blocks of up to blockSize elements, until pushBlock()
+			returns false. Contiguous elements are pushed in place, others are gathered into a buffer first
+		*/
+		template<typename Sink>
+		void forEachRemainingBlock(Sink& sink, size_t blockSize, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		{
+			if constexpr(IsContiguous)
+			{
+				const size_t size = estimateSize();
+				auto* values = size == 0 ? nullptr : std::addressof(*m_Current);
+
+				for(size_t offset = 0;offset < size;offset += blockSize)
+				{
+					const size_t count = std::min(blockSize, size - offset);
+					m_Current += static_cast<Difference>(count);
+
+					if(!pushBlock(sink, Block<std::remove_reference_t<decltype(*values)>, false>{values + offset, nullptr, count}))
+					{
+						return;
+					}
+				}
+			}
+			else
+			{
+				using Value = std::decay_t<decltype(*m_Current)>;
+				constexpr bool Movable = std::is_rvalue_reference_v<decltype(*m_Current)>;
+
+				std::pmr::vector<Value> buffer(resource);
+				buffer.reserve(blockSize);
+
+				while(m_Current != m_End)
+				{
+					buffer.clear();
+
+					for(;buffer.size() < blockSize && m_Current != m_End;++m_Current)
+					{
+						buffer.emplace_back(*m_Current);
+					}
+
+					if(!pushBlock(sink, Block<Value, Movable>{buffer.data(), nullptr, buffer.size()}))
+					{
+						return;
+					}
+				}
+			}
+		}
+
+		/*
+			Drops up to count elements without reading them, in O(1) for random-access iterators.
+			Returns the number of elements dropped
+		*/
+		STREAM_CONSTEXPR size_t skip(size_t count)
+		{
+			if constexpr(IsRandomAccess)
+			{
+				const size_t skipped = std::min(count, estimateSize());
+				m_Current += static_cast<Difference>(skipped);
+				return skipped;
+			}
+			else
+			{
+				size_t skipped = 0;
+				for(;skipped < count && m_Current != m_End;++skipped)
+				{
+					++m_Current;
+				}
+
+				if(m_Size != UnknownSize)
+				{
+					m_Size -= std::min(m_Size, skipped);
+				}
+
+				return skipped;
+			}
+		}
+
+		/*
+			Drops every remaining element
+		*/
+		STREAM_CONSTEXPR void exhaust()
+		{
+			m_Current = m_End;
+			m_Size = 0;
+		}
+
+		static constexpr bool IsSplittable = std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+
+	private:
+		using Difference = typename std::iterator_traits<Iterator>::difference_type;
+
+		static constexpr bool IsRandomAccess = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+		static constexpr bool IsForward = IsSplittable;
+		static constexpr bool IsContiguous = isContiguous<T, Iterator>();
+		static constexpr size_t BatchSizeIncrement = 1024;
+
+		Iterator m_Current;
+		Iterator m_End;
+		unsigned m_Characteristics;
+		size_t m_Size;
+		size_t m_BatchSize = BatchSizeIncrement;
+	};
+
+
+	/*
+		Characteristics of the elements of a container, deduced from its interface.
+
+		Containers whose insert(value) returns a pair<iterator, bool> only hold unique keys, and
+		containers with a key_compare keep their keys in its order. Since DISTINCT and SORTED are
+		about operator== and operator<, both are only set if the container compares its keys with
+		them, i.e. with the default std::less or std::equal_to. Containers of other values than their
+		keys, e.g. std::multimap, are only SORTED if the keys are unique, as the values of equal
+		keys are not sorted. Containers with a hasher, like std::unordered_set, hold no meaningful order
+	*/
+	template<typename Container, typename = void>
+	struct IsHashedContainer : std::false_type
+	{
+
+	};
+
+	template<typename Container>
+	struct IsHashedContainer<Container, std::void_t<typename Container::hasher>> : std::true_type
+	{
+
+	};
+
+	template<typename Container, typename = void>
+	struct IsUniqueContainer : std::false_type
+	{
+
+	};
+
+	template<typename Container>
+	struct IsUniqueContainer<Container, std::void_t<decltype(std::declval<Container&>().insert(std::declval<const typename Container::value_type&>()).second)>> : std::true_type
+	{
+
+	};
+
+	template<typename Container, typename = void>
+	struct HasNaturalOrder : std::false_type
+	{
+
+	};
+
+	template<typename Container>
+	struct HasNaturalOrder<Container, std::void_t<typename Container::key_compare>>
+		: std::bool_constant<std::is_same_v<typename Container::key_compare, std::less<typename Container::key_type>>
+			|| std::is_same_v<typename Container::key_compare, std::less<>>>
+	{
+
+	};
+
+	template<typename Container, typename = void>
+	struct HasNaturalEquality : std::false_type
+	{
+
+	};
+
+	template<typename Container>
+	struct HasNaturalEquality<Container, std::void_t<typename Container::key_equal>>
+		: std::bool_constant<std::is_same_v<typename Container::key_equal, std::equal_to<typename Container::key_type>>
+			|| std::is_same_v<typename Container::key_equal, std::equal_to<>>>
+	{
+
+	};
+
+	template<typename Container, typename = void>
+	struct IsSortedContainer : std::false_type
+	{
+
+	};
+
+	template<typename Container>
+	struct IsSortedContainer<Container, std::void_t<typename Container::key_compare>>
+		: std::bool_constant<HasNaturalOrder<Container>::value
+			&& (std::is_same_v<typename Container::key_type, typename Container::value_type> || IsUniqueContainer<Container>::value)>
+	{
+
+	};
+
+	template<typename Container>
+	struct IsDistinctContainer
+		: std::bool_constant<IsUniqueContainer<Container>::value && (HasNaturalOrder<Container>::value || HasNaturalEquality<Container>::value)>
+	{
+
+	};
+
+	template<typename Container, typename = void>
+	struct HasSize : std::false_type
+	{
+
+	};
+
+	template<typename Container>
+	struct HasSize<Container, std::void_t<decltype(std::size(std::declval<const Container&>()))>> : std::true_type
+	{
+
+	};
+
+	template<typename Container>
+	constexpr unsigned containerCharacteristics()
+	{
+		unsigned characteristics = IsHashedContainer<Container>::value ? 0u : ORDERED;
+
+		if constexpr(IsSortedContainer<Container>::value)
+		{
+			characteristics |= SORTED;
+		}
+
+		if constexpr(IsDistinctContainer<Container>::value)
+		{
+			characteristics |= DISTINCT;
+		}
+
+		return characteristics;
+	}
+
+	template<typename Container>
+	STREAM_CONSTEXPR size_t containerSize(const Container& container)
+	{
+		if constexpr(HasSize<Container>::value)
+		{
+			return static_cast<size_t>(std::size(container));
+		}
+		else
+		{
+			return UnknownSize;
+		}
+	}
+
+	// ===> FILES <===
+
+
+	/*
+		Read-only contents of a file, memory-mapped where the platform supports it and
+		read into a buffer otherwise, e.g. for pipes. The contents stay valid for the
+		lifetime of the object, so the streams over a file share its ownership
+	*/
+	class MappedFile
+	{
+	public:
+
+		/*
+			Throws std::runtime_error if the file cannot be read
+		*/
+		explicit MappedFile(const std::string& path)
+		{
+#if defined(STREAM_HAS_MMAP)
+			if(map(path))
+			{
+				return;
+			}
+#endif
+			read(path);
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile()
+		{
+#if defined(STREAM_HAS_MMAP)
+			if(m_Mapped)
+			{
+				::munmap(const_cast<char*>(m_Data), m_Size);
+			}
+#endif
+		}
+
+		const char* data() const
+		{
+			return m_Data;
+		}
+
+		size_t size() const
+		{
+			return m_Size;
+		}
+
+	private:
+
+#if defined(STREAM_HAS_MMAP)
+		/*
+			Maps a regular file. Returns false if it cannot be mapped, or reports no size
+			like the files of /proc, so it is read instead
+		*/
+		bool map(const std::string& path)
+		{
+			const int descriptor = ::open(path.c_str(), O_RDONLY);
+			if(descriptor < 0)
+			{
+				return false;
+			}
+
+			struct stat status;
+			if(::fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0)
+			{
+				::close(descriptor);
+				return false;
+			}
+
+			const size_t size = static_cast<size_t>(status.st_size);
+			void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			::close(descriptor);
+
+			if(mapping == MAP_FAILED)
+			{
+				return false;
+			}
+
+			m_Data = static_cast<const char*>(mapping);
+			m_Size = size;
+			m_Mapped = true;
+
+			return true;
+		}
+#endif
+
+		void read(const std::string& path)
+		{
+			std::ifstream file(path, std::ios::binary);
+			if(!file)
+			{
+				throw std::runtime_error("Cannot open " + path);
+			}
+
+			std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			if(file.bad())
+			{
+				throw std::runtime_error("Cannot read " + path);
+			}
+
+			m_Size = contents.size();
+			m_Buffer.reset(new char[m_Size]);
+			std::memcpy(m_Buffer.get(), contents.data(), m_Size);
+			m_Data = m_Buffer.get();
+		}
+
+		const char* m_Data = nullptr;
+		size_t m_Size = 0;
+		bool m_Mapped = false;
+		std::unique_ptr<char[]> m_Buffer;
+	};
+
+
+	/*
+		Forward iterator over the lines of a character buffer, as views without their '\n' terminator.
+		A last line without a terminator is included, but there is no empty line after a final '\n'
+	*/
+	class LineIterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const std::string_view*;
+		using reference = std::string_view;
+
+		LineIterator() = default;
+
+		/*
+			==> const char* line: the start of the current line
+			==> const char* end: the end of the buffer
+		*/
+		LineIterator(const char* line, const char* end)
+			: m_Line(line), m_LineEnd(findLineEnd(line, end)), m_End(end)
+		{
+
+		}
+
+		std::string_view operator*() const
+		{
+			return std::string_view(m_Line, static_cast<size_t>(m_LineEnd - m_Line));
+		}
+
+		LineIterator& operator++()
+		{
+			m_Line = m_LineEnd == m_End ? m_End : m_LineEnd + 1;
+			m_LineEnd = findLineEnd(m_Line, m_End);
+			return *this;
+		}
+
+		LineIterator operator++(int)
+		{
+			LineIterator previous = *this;
+			++*this;
+			return previous;
+		}
+
+		bool operator==(const LineIterator& other) const
+		{
+			return m_Line == other.m_Line;
+		}
+
+		bool operator!=(const LineIterator& other) const
+		{
+			return m_Line != other.m_Line;
+		}
+
+		/*
+			The start of the first line after the middle byte up to end, so a Spliterator
+			splits the lines of a buffer in constant time instead of walking them
+		*/
+		LineIterator middle(const LineIterator& end) const
+		{
+			const char* half = m_Line + (end.m_Line - m_Line) / 2;
+			if(half == m_Line)
+			{
+				return *this;
+			}
+
+			const void* newline = std::memchr(half - 1, '\n', static_cast<size_t>(end.m_Line - half) + 1);
+			if(newline == nullptr)
+			{
+				return end;
+			}
+
+			return LineIterator(static_cast<const char*>(newline) + 1, m_End);
+		}
+
+	private:
+
+		static const char* findLineEnd(const char* line, const char* end)
+		{
+			if(line == end)
+			{
+				return end;
+			}
+
+			const void* newline = std::memchr(line, '\n', static_cast<size_t>(end - line));
+			return newline == nullptr ? end : static_cast<const char*>(newline);
+		}
+
+		const char* m_Line = nullptr;
+		const char* m_LineEnd = nullptr;
+		const char* m_End = nullptr;
+	};
+
+	// ===> GENERATORS <===
+
+
+	/*
+		Random-access iterator over the values start + index * step of an arithmetic progression.
+		Each value is computed from its index, so floating-point steps do not accumulate rounding errors
+	*/
+	template<typename T>
+	class RangeIterator
+	{
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = T;
+
+		RangeIterator() = default;
+
+		STREAM_CONSTEXPR RangeIterator(T start, T step, size_t index)
+			: m_Start(start), m_Step(step), m_Index(index)
+		{
+
+		}
+
+		STREAM_CONSTEXPR T operator*() const
+		{
+			if constexpr(std::is_integral_v<T>)
+			{
+				// Unsigned arithmetic wraps, so ranges spanning more than the maximum of T do not overflow
+				using Unsigned = std::make_unsigned_t<T>;
+				return static_cast<T>(static_cast<Unsigned>(m_Start) + static_cast<Unsigned>(m_Index) * static_cast<Unsigned>(m_Step));
+			}
+			else
+			{
+				return static_cast<T>(m_Start + static_cast<T>(m_Index) * m_Step);
+			}
+		}
+
+		STREAM_CONSTEXPR T operator[](difference_type offset) const
+		{
+			return *(*this + offset);
+		}
+
+		STREAM_CONSTEXPR RangeIterator& operator++()
+		{
+			++m_Index;
+			return *this;
+		}
+
+		STREAM_CONSTEXPR RangeIterator operator++(int)
+		{
+			RangeIterator previous = *this;
+			++m_Index;
+			return previous;
+		}
+
+		STREAM_CONSTEXPR RangeIterator& operator--()
+		{
+			--m_Index;
+			return *this;
+		}
+
+		STREAM_CONSTEXPR RangeIterator operator--(int)
+		{
+			RangeIterator previous = *this;
+			--m_Index;
+			return previous;
+		}
+
+		STREAM_CONSTEXPR RangeIterator& operator+=(difference_type offset)
+		{
+			m_Index += static_cast<size_t>(offset);
+			return *this;
+		}
+
+		STREAM_CONSTEXPR RangeIterator& operator-=(difference_type offset)
+		{
+			m_Index -= static_cast<size_t>(offset);
+			return *this;
+		}
+
+		STREAM_CONSTEXPR RangeIterator operator+(difference_type offset) const
+		{
+			return RangeIterator(*this) += offset;
+		}
+
+		STREAM_CONSTEXPR friend RangeIterator operator+(difference_type offset, const RangeIterator& iterator)
+		{
+			return iterator + offset;
+		}
+
+		STREAM_CONSTEXPR RangeIterator operator-(difference_type offset) const
+		{
+			return RangeIterator(*this) -= offset;
+		}
+
+		STREAM_CONSTEXPR difference_type operator-(const RangeIterator& other) const
+		{
+			return static_cast<difference_type>(m_Index - other.m_Index);
+		}
+
+		STREAM_CONSTEXPR bool operator==(const RangeIterator& other) const
+		{
+			return m_Index == other.m_Index;
+		}
+
+		STREAM_CONSTEXPR bool operator!=(const RangeIterator& other) const
+		{
+			return m_Index != other.m_Index;
+		}
+
+		STREAM_CONSTEXPR bool operator<(const RangeIterator& other) const
+		{
+			return m_Index < other.m_Index;
+		}
+
+		STREAM_CONSTEXPR bool operator>(const RangeIterator& other) const
+		{
+			return m_Index > other.m_Index;
+		}
+
+		STREAM_CONSTEXPR bool operator<=(const RangeIterator& other) const
+		{
+			return m_Index <= other.m_Index;
+		}
+
+		STREAM_CONSTEXPR bool operator>=(const RangeIterator& other) const
+		{
+			return m_Index >= other.m_Index;
+		}
+
+	private:
+		T m_Start = T();
+		T m_Step = T();
+		size_t m_Index = 0;
+	};
+
+	/*
+		The number of values of the progression from begin by step before reaching end
+	*/
+	template<typename T>
+	STREAM_CONSTEXPR size_t rangeSize(T begin, T end, T step)
+	{
+		if constexpr(std::is_integral_v<T>)
+		{
+			using Unsigned = std::make_unsigned_t<T>;
+
+			if(step > 0 ? begin >= end : begin <= end)
+			{
+				return 0;
+			}
+
+			const Unsigned distance = step > 0 ? static_cast<Unsigned>(static_cast<Unsigned>(end) - static_cast<Unsigned>(begin))
+				: static_cast<Unsigned>(static_cast<Unsigned>(begin) - static_cast<Unsigned>(end));
+			const Unsigned magnitude = step > 0 ? static_cast<Unsigned>(step) : static_cast<Unsigned>(Unsigned(0) - static_cast<Unsigned>(step));
+
+			return static_cast<size_t>(distance / magnitude + (distance % magnitude != 0 ? 1 : 0));
+		}
+		else
+		{
+			// NaN steps are empty, and counts beyond size_t, e.g. towards an infinite end, never end.
+			// The ceiling is taken by hand, as std::ceil is not constexpr
+			const T steps = (end - begin) / step;
+			if(!(steps > 0))
+			{
+				return 0;
+			}
+
+			if(!(steps < static_cast<T>(UnknownSize)))
+			{
+				return UnknownSize;
+			}
+
+			const size_t whole = static_cast<size_t>(steps);
+			return static_cast<T>(whole) < steps ? whole + 1 : whole;
+		}
+	}
+
+	/*
+		Input iterator over the values returned by successive calls to a supplier, which is never exhausted.
+
+		The supplier is called once per element, and only when the element is read or skipped:
+		moving past the last element a pipeline needs does not call it again
+	*/
+	template<typename T, typename Supplier>
+	class GenerateIterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = const T&;
+
+		/*
+			==> Supplier supplier: the function returning each element
+			==> bool end: whether this is the end sentinel, which is never reached
+		*/
+		GenerateIterator(Supplier supplier, bool end)
+			: m_Supplier(std::move(supplier)), m_End(end)
+		{
+
+		}
+
+		const T& operator*() const
+		{
+			if(!m_Value.has_value())
+			{
+				m_Value.emplace(m_Supplier());
+			}
+
+			return m_Value.value();
+		}
+
+		GenerateIterator& operator++()
+		{
+			if(!m_Value.has_value())
+			{
+				m_Supplier();
+			}
+
+			m_Value.reset();
+			return *this;
+		}
+
+		GenerateIterator operator++(int)
+		{
+			GenerateIterator previous = *this;
+			++*this;
+			return previous;
+		}
+
+		bool operator==(const GenerateIterator& other) const
+		{
+			return m_End == other.m_End;
+		}
+
+		bool operator!=(const GenerateIterator& other) const
+		{
+			return m_End != other.m_End;
+		}
+
+	private:
+		mutable Supplier m_Supplier;
+		mutable Optional<T> m_Value;
+		bool m_End;
+	};
+
+#if defined(STREAM_HAS_COROUTINES)
+
+	// ===> COROUTINES <===
+
+
+	/*
+		Storage of the result of a Task
+	*/
+	template<typename T>
+	struct TaskResult
+	{
+		Optional<T> m_Value;
+
+		template<typename U>
+		void return_value(U&& value)
+		{
+			m_Value.emplace(std::forward<U>(value));
+		}
+
+		T get()
+		{
+			return std::move(m_Value.value());
+		}
+	};
+
+	template<>
+	struct TaskResult<void>
+	{
+		void return_void()
+		{
+
+		}
+
+		void get()
+		{
+
+		}
+	};
+
+	/*
+		Lazy coroutine returning a T, which starts when it is awaited. The awaiting coroutine
+		is resumed by symmetric transfer once it completes, so chains of tasks do not grow the stack
+	*/
+	template<typename T = void>
+	class Task
+	{
+	public:
+
+		struct promise_type : TaskResult<T>
+		{
+			std::coroutine_handle<> m_Continuation = std::noop_coroutine();
+			std::exception_ptr m_Exception;
+
+			Task get_return_object()
+			{
+				return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+
+			std::suspend_always initial_suspend() noexcept
+			{
+				return {};
+			}
+
+			auto final_suspend() noexcept
+			{
+				struct ResumeContinuation
+				{
+					bool await_ready() noexcept
+					{
+						return false;
+					}
+
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+					{
+						return handle.promise().m_Continuation;
+					}
+
+					void await_resume() noexcept
+					{
+
+					}
+				};
+
+				return ResumeContinuation{};
+			}
+
+			void unhandled_exception()
+			{
+				m_Exception = std::current_exception();
+			}
+		};
+
+		Task(Task&& other) noexcept
+			: m_Handle(std::exchange(other.m_Handle, nullptr))
+		{
+
+		}
+
+		Task& operator=(Task&& other) noexcept
+		{
+			std::swap(m_Handle, other.m_Handle);
+			return *this;
+		}
+
+		~Task()
+		{
+			if(m_Handle)
+			{
+				m_Handle.destroy();
+			}
+		}
+
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{
+			m_Handle.promise().m_Continuation = awaiting;
+			return m_Handle;
+		}
+
+		/*
+			The result of the task, or the exception it threw
+		*/
+		T await_resume()
+		{
+			if(m_Handle.promise().m_Exception)
+			{
+				std::rethrow_exception(m_Handle.promise().m_Exception);
+			}
+
+			return m_Handle.promise().get();
+		}
+
+	private:
+
+		explicit Task(std::coroutine_handle<promise_type> handle)
+			: m_Handle(handle)
+		{
+
+		}
+
+		std::coroutine_handle<promise_type> m_Handle;
+	};
+
+	/*
+		Coroutine producing elements of type T with co_yield, while it may co_await its input, e.g. a socket.
+
+		It only runs while its consumer awaits next(): between two elements it stays suspended at co_yield,
+		so a slow consumer holds back the producer instead of letting elements pile up
+	*/
+	template<typename T>
+	class AsyncGenerator
+	{
+	public:
+		using value_type = T;
+
+		struct promise_type
+		{
+			Optional<T> m_Value;
+			std::coroutine_handle<> m_Consumer = std::noop_coroutine();
+			std::exception_ptr m_Exception;
+
+			AsyncGenerator get_return_object()
+			{
+				return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+
+			std::suspend_always initial_suspend() noexcept
+			{
+				return {};
+			}
+
+			auto final_suspend() noexcept
+			{
+				return ResumeConsumer{};
+			}
+
+			template<typename U>
+			auto yield_value(U&& value)
+			{
+				m_Value.emplace(std::forward<U>(value));
+				return ResumeConsumer{};
+			}
+
+			void return_void()
+			{
+
+			}
+
+			void unhandled_exception()
+			{
+				m_Exception = std::current_exception();
+			}
+		};
+
+		AsyncGenerator(AsyncGenerator&& other) noexcept
+			: m_Handle(std::exchange(other.m_Handle, nullptr))
+		{
+
+		}
+
+		AsyncGenerator& operator=(AsyncGenerator&& other) noexcept
+		{
+			std::swap(m_Handle, other.m_Handle);
+			return *this;
+		}
+
+		~AsyncGenerator()
+		{
+			if(m_Handle)
+			{
+				m_Handle.destroy();
+			}
+		}
+
+		/*
+			Awaitable resuming the generator until it yields its next element. It gives
+			nothing once the generator returns, and rethrows the exceptions it throws
+		*/
+		auto next()
+		{
+			struct NextAwaiter
+			{
+				std::coroutine_handle<promise_type> m_Handle;
+
+				bool await_ready() const noexcept
+				{
+					return m_Handle.done();
+				}
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+				{
+					m_Handle.promise().m_Consumer = consumer;
+					return m_Handle;
+				}
+
+				Optional<T> await_resume()
+				{
+					promise_type& promise = m_Handle.promise();
+					if(promise.m_Exception)
+					{
+						std::rethrow_exception(std::exchange(promise.m_Exception, nullptr));
+					}
+
+					Optional<T> value = std::move(promise.m_Value);
+					promise.m_Value.reset();
+					return value;
+				}
+			};
+
+			return NextAwaiter{m_Handle};
+		}
+
+	private:
+
+		struct ResumeConsumer
+		{
+			bool await_ready() noexcept
+			{
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+			{
+				return handle.promise().m_Consumer;
+			}
+
+			void await_resume() noexcept
+			{
+
+			}
+		};
+
+		explicit AsyncGenerator(std::coroutine_handle<promise_type> handle)
+			: m_Handle(handle)
+		{
+
+		}
+
+		std::coroutine_handle<promise_type> m_Handle;
+	};
+
+	/*
+		Coroutine started on creation and destroyed once it completes, used by syncWait()
+	*/
+	struct DetachedTask
+	{
+		struct promise_type
+		{
+			DetachedTask get_return_object()
+			{
+				return {};
+			}
+
+			std::suspend_never initial_suspend() noexcept
+			{
+				return {};
+			}
+
+			std::suspend_never final_suspend() noexcept
+			{
+				return {};
+			}
+
+			void return_void()
+			{
+
+			}
+
+			void unhandled_exception()
+			{
+				std::terminate();
+			}
+		};
+	};
+
+	/*
+		Runs task and blocks the calling thread until it completes, wherever the task is resumed.
+		Returns its result or rethrows its exception. Meant for main() and tests, not for coroutines
+	*/
+	template<typename T>
+	T syncWait(Task<T> task)
+	{
+		struct State
+		{
+			std::mutex m_Mutex;
+			std::condition_variable m_Done;
+			bool m_Finished = false;
+			std::exception_ptr m_Exception;
+			Optional<std::conditional_t<std::is_void_v<T>, bool, T>> m_Value;
+		};
+
+		State state;
+
+		[](Task<T>& task, State& state) -> DetachedTask
+		{
+			try
+			{
+				if constexpr(std::is_void_v<T>)
+				{
+					co_await task;
+				}
+				else
+				{
+					state.m_Value.emplace(co_await task);
+				}
+			}
+			catch(...)
+			{
+				state.m_Exception = std::current_exception();
+			}
+
+			// Notified under the lock, so the waiting thread cannot destroy the state before
+			std::lock_guard<std::mutex> lock(state.m_Mutex);
+			state.m_Finished = true;
+			state.m_Done.notify_one();
+		}(task, state);
+
+		std::unique_lock<std::mutex> lock(state.m_Mutex);
+		state.m_Done.wait(lock, [&]() { return state.m_Finished; });
+
+		if(state.m_Exception)
+		{
+			std::rethrow_exception(state.m_Exception);
+		}
+
+		if constexpr(!std::is_void_v<T>)
+		{
+			return std::move(state.m_Value.value());
+		}
+	}
+
+#endif
+
+	// ===> SIMD KERNELS <===
+
+
+	/*
+		Kernels used by the terminal operations of contiguous sources of arithmetic types.
+
+		They are vectorized with std::experimental::simd when the standard library provides it,
+		which maps to the widest instruction set enabled for the target (SSE, AVX2, NEON...).
+		Define STREAM_NO_SIMD to always use the scalar loops.
+
+		Summing floating-point values in SIMD lanes changes the order of the additions, and so
+		the rounding of the result, and SIMD min/max do not handle NaN like the scalar comparisons.
+		These kernels only vectorize floating-point types when reassociation is allowed
+	*/
+	namespace kernels
+	{
+
+		template<typename T>
+		constexpr bool isExactInSimd()
+		{
+			return std::is_integral_v<T>;
+		}
+
+#ifdef STREAM_HAS_SIMD
+
+		template<typename V, typename T>
+		V load(const T* values)
+		{
+			using Value = typename V::value_type;
+
+			if constexpr(std::is_same_v<Value, T>)
+			{
+				return V(values, std::experimental::element_aligned);
+			}
+			else
+			{
+				return V([values](auto lane) { return static_cast<Value>(values[lane]); });
+			}
+		}
+
+#endif
+
+		/*
+			Sums values[0, size) into an accumulator of type R, starting from identity
+		*/
+		template<typename R, typename T>
+		R sum(const T* values, size_t size, R identity, bool reassociate)
+		{
+			size_t i = 0;
+			R result = identity;
+
+#ifdef STREAM_HAS_SIMD
+			if(reassociate || (isExactInSimd<R>() && isExactInSimd<T>()))
+			{
+				using V = std::experimental::native_simd<R>;
+
+				V first = R();
+				V second = R();
+
+				for(;i + 2 * V::size() <= size;i += 2 * V::size())
+				{
+					first += load<V>(values + i);
+					second += load<V>(values + i + V::size());
+				}
+
+				result += std::experimental::reduce(first + second);
+			}
+#else
+			(void)reassociate;
+#endif
+
+			for(;i < size;++i)
+			{
+				result += (R) values[i];
+			}
+
+			return result;
+		}
+
+		/*
+			Adds value to sum with Neumaier's variant of Kahan summation, which also compensates
+			values larger than the sum. The rounding error is accumulated into compensation
+		*/
+		template<typename R>
+		void addCompensated(R& sum, R& compensation, R value)
+		{
+			const R next = sum + value;
+
+			if(std::abs(sum) >= std::abs(value))
+			{
+				compensation += (sum - next) + value;
+			}
+			else
+			{
+				compensation += (value - next) + sum;
+			}
+
+			sum = next;
+		}
+
+		/*
+			Sums values[0, size) with addCompensated() as (sum, compensation), whose total is the result.
+			With reassociate, each SIMD lane compensates its own sum, then the lanes are added in order
+		*/
+		template<typename R, typename T>
+		std::pair<R, R> compensatedSum(const T* values, size_t size, bool reassociate)
+		{
+			size_t i = 0;
+			R sum = R();
+			R compensation = R();
+
+#ifdef STREAM_HAS_SIMD
+			if(reassociate)
+			{
+				using V = std::experimental::native_simd<R>;
+
+				V sumLanes = R();
+				V compensationLanes = R();
+
+				for(;i + V::size() <= size;i += V::size())
+				{
+					const V value = load<V>(values + i);
+					const V next = sumLanes + value;
+					const auto sumIsLarger = std::experimental::abs(sumLanes) >= std::experimental::abs(value);
+
+					V larger = value;
+					V smaller = sumLanes;
+					where(sumIsLarger, larger) = sumLanes;
+					where(sumIsLarger, smaller) = value;
+
+					compensationLanes += (larger - next) + smaller;
+					sumLanes = next;
+				}
+
+				for(size_t lane = 0;lane < V::size();++lane)
+				{
+					addCompensated(sum, compensation, R(sumLanes[lane]));
+					compensation += compensationLanes[lane];
+				}
+			}
+#else
+			(void)reassociate;
+#endif
+
+			for(;i < size;++i)
+			{
+				addCompensated(sum, compensation, static_cast<R>(values[i]));
+			}
+
+			return {sum, compensation};
+		}
+
+		/*
+			The smallest (Less = true) or greatest (Less = false) of values[0, size). Size must not be 0
+		*/
+		template<bool Less, typename T>
+		T extreme(const T* values, size_t size, bool reassociate)
+		{
+			size_t i = 1;
+			T result = values[0];
+
+#ifdef STREAM_HAS_SIMD
+			using V = std::experimental::native_simd<T>;
+
+			if((reassociate || isExactInSimd<T>()) && size >= V::size())
+			{
+				V extremes = load<V>(values);
+
+				for(i = V::size();i + V::size() <= size;i += V::size())
+				{
+					extremes = Less ? std::experimental::min(extremes, load<V>(values + i)) : std::experimental::max(extremes, load<V>(values + i));
+				}
+
+				result = Less ? std::experimental::hmin(extremes) : std::experimental::hmax(extremes);
+			}
+#else
+			(void)reassociate;
+#endif
+
+			for(;i < size;++i)
+			{
+				if(Less ? values[i] < result : values[i] > result)
+				{
+					result = values[i];
+				}
+			}
+
+			return result;
+		}
+
+		/*
+			Sums the deviations d = values[i] - mean of values[0, size) as (sum of d^2, sum of d).
+			The second one is the rounding error of mean, which corrects the two-pass variance
+		*/
+		template<typename T>
+		std::pair<double, double> deviations(const T* values, size_t size, double mean, bool reassociate)
+		{
+			size_t i = 0;
+			double squares = 0;
+			double deviations = 0;
+
+#ifdef STREAM_HAS_SIMD
+			if(reassociate)
+			{
+				using V = std::experimental::native_simd<double>;
+
+				const V means = mean;
+				V squareLanes = 0.0;
+				V deviationLanes = 0.0;
+
+				for(;i + V::size() <= size;i += V::size())
+				{
+					const V deviation = load<V>(values + i) - means;
+					squareLanes += deviation * deviation;
+					deviationLanes += deviation;
+				}
+
+				squares = std::experimental::reduce(squareLanes);
+				deviations = std::experimental::reduce(deviationLanes);
+			}
+#else
+			(void)reassociate;
+#endif
+
+			for(;i < size;++i)
+			{
+				const double deviation = static_cast<double>(values[i]) - mean;
+				squares += deviation * deviation;
+				deviations += deviation;
+			}
+
+			return {squares, deviations};
+		}
+
+		/*
+			Whether Accumulate is std::plus, so a reduction with it can use the sum kernel
+		*/
+		template<typename Accumulate, typename T>
+		constexpr bool isPlus()
+		{
+			return std::is_same_v<Accumulate, std::plus<T>> || std::is_same_v<Accumulate, std::plus<>>;
+		}
+	}
+
+// ===============================================================================================================================
+
+
+	// ===> HASH TABLES <===
+
+
+	/*
+		Mixes the bits of a hash, so that identity hashes like std::hash<int>
+		spread consecutive keys over the whole table
+	*/
+	inline size_t mixHash(size_t hash)
+	{
+		uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(mixed ^ (mixed >> 32));
+	}
+
+	/*
+		Insert-only open-addressing hash table, base of FlatHashSet and FlatHashMap
+
+		Values are stored in a single contiguous array probed linearly, next to one control
+		byte per slot holding 7 bits of the hash, so most mismatching slots are skipped without
+		comparing keys. Unlike the std unordered containers, inserting does not allocate a node per value.
+		The table is allocated from a std::pmr::memory_resource, the default one unless setResource() is called,
+		on the first insertion. Values are moved into a new allocation when the table grows, or copied if moving them
+		may throw, so a copy throwing leaves the table as it was. Hash functions must not throw
+
+		==> Key: the type of the keys
+		==> Value: the type of the values stored, from which KeyOf::key(value) extracts the key
+		==> Hash: hash function of the keys
+		==> Equal: equality of the keys, consistent with Hash
+
+	*/
+	template<typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+	class FlatHashTable
+	{
+	public:
+		using key_type = Key;
+		using value_type = Value;
+		using hasher = Hash;
+		using key_equal = Equal;
+
+		/*
+			Iterates over the occupied slots of the table, in no particular order
+		*/
+		template<typename V>
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::remove_const_t<V>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = V*;
+			using reference = V&;
+
+			Iterator() = default;
+
+			Iterator(const uint8_t* control, V* slots, size_t index, size_t capacity)
+				: m_Control(control), m_Slots(slots), m_Index(index), m_Capacity(capacity)
+			{
+				skipEmpty();
+			}
+
+			V& operator*() const
+			{
+				return m_Slots[m_Index];
+			}
+
+			V* operator->() const
+			{
+				return m_Slots + m_Index;
+			}
+
+			Iterator& operator++()
+			{
+				++m_Index;
+				skipEmpty();
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator previous = *this;
+				++*this;
+				return previous;
+			}
+
+			bool operator==(const Iterator& other) const
+			{
+				return m_Index == other.m_Index;
+			}
+
+			bool operator!=(const Iterator& other) const
+			{
+				return m_Index != other.m_Index;
+			}
+
+		private:
+
+			void skipEmpty()
+			{
+				while(m_Index < m_Capacity && m_Control[m_Index] == Empty)
+				{
+					++m_Index;
+				}
+			}
+
+		private:
+			const uint8_t* m_Control = nullptr;
+			V* m_Slots = nullptr;
+			size_t m_Index = 0;
+			size_t m_Capacity = 0;
+		};
+
+		/*
+			Delegates to another constructor, so the destructor frees the values already copied if a copy throws
+		*/
+		FlatHashTable(const FlatHashTable& other)
+			: FlatHashTable(0, other.m_Hash, other.m_Equal)
+		{
+			m_Resource = other.m_Resource;
+			m_InitialCapacity = other.m_InitialCapacity;
+
+			if(other.m_Size > 0)
+			{
+				// Same hash function and capacity, so the values keep their slots
+				allocate(other.m_Capacity);
+
+				for(size_t i = 0;i < m_Capacity;++i)
+				{
+					if(other.m_Control[i] != Empty)
+					{
+						new(m_Slots + i) Value(other.m_Slots[i]);
+						m_Control[i] = other.m_Control[i];
+						m_Size++;
+					}
+				}
+			}
+		}
+
+		FlatHashTable(FlatHashTable&& other) noexcept
+			: m_Hash(std::move(other.m_Hash)), m_Equal(std::move(other.m_Equal)), m_Resource(other.m_Resource),
+			  m_Control(std::exchange(other.m_Control, nullptr)), m_Slots(std::exchange(other.m_Slots, nullptr)),
+			  m_Capacity(std::exchange(other.m_Capacity, 0)), m_Size(std::exchange(other.m_Size, 0)), m_InitialCapacity(other.m_InitialCapacity)
+		{
+
+		}
+
+		FlatHashTable& operator=(FlatHashTable other) noexcept
+		{
+			std::swap(m_Hash, other.m_Hash);
+			std::swap(m_Equal, other.m_Equal);
+			std::swap(m_Resource, other.m_Resource);
+			std::swap(m_Control, other.m_Control);
+			std::swap(m_Slots, other.m_Slots);
+			std::swap(m_Capacity, other.m_Capacity);
+			std::swap(m_Size, other.m_Size);
+			std::swap(m_InitialCapacity, other.m_InitialCapacity);
+			return *this;
+		}
+
+		~FlatHashTable()
+		{
+			clear();
+			deallocate();
+		}
+
+		bool contains(const Key& key) const
+		{
+			return find(key) != nullptr;
+		}
+
+		size_t size() const
+		{
+			return m_Size;
+		}
+
+		/*
+			The number of slots, some of them empty
+		*/
+		size_t capacity() const
+		{
+			return m_Capacity;
+		}
+
+		bool empty() const
+		{
+			return m_Size == 0;
+		}
+
+		/*
+			Grows the table so it holds size values without growing again. Tables not allocated yet
+			only allocate on the first insertion, so setResource() doesn't allocate them a second time
+		*/
+		void reserve(size_t size)
+		{
+			size_t capacity = m_Capacity == 0 ? MinCapacity : m_Capacity;
+			while(size * MaxLoadDenominator > capacity * MaxLoadNumerator)
+			{
+				capacity *= 2;
+			}
+
+			if(m_Capacity == 0)
+			{
+				m_InitialCapacity = std::max(m_InitialCapacity, capacity);
+			}
+			else if(capacity > m_Capacity)
+			{
+				rehash(capacity, m_Resource);
+			}
+		}
+
+		/*
+			Removes every value, keeping the memory of the table
+		*/
+		void clear()
+		{
+			for(size_t i = 0;i < m_Capacity;++i)
+			{
+				if(m_Control[i] != Empty)
+				{
+					m_Slots[i].~Value();
+					m_Control[i] = Empty;
+				}
+			}
+
+			m_Size = 0;
+		}
+
+		/*
+			Makes the table allocate from resource, moving the values already inserted into it
+		*/
+		void setResource(std::pmr::memory_resource* resource)
+		{
+			if(resource != m_Resource)
+			{
+				if(m_Capacity > 0)
+				{
+					rehash(m_Capacity, resource);
+				}
+				else
+				{
+					m_Resource = resource;
+				}
+			}
+		}
+
+		std::pmr::memory_resource* resource() const
+		{
+			return m_Resource;
+		}
+
+		Hash hash_function() const
+		{
+			return m_Hash;
+		}
+
+		Equal key_eq() const
+		{
+			return m_Equal;
+		}
+
+		template<typename Action>
+		void forEach(Action action) const
+		{
+			for(size_t i = 0;i < m_Capacity;++i)
+			{
+				if(m_Control[i] != Empty)
+				{
+					action(std::as_const(m_Slots[i]));
+				}
+			}
+		}
+
+	protected:
+
+		FlatHashTable(size_t expectedSize, Hash hash, Equal equal)
+			: m_Hash(std::move(hash)), m_Equal(std::move(equal))
+		{
+			reserve(expectedSize);
+		}
+
+		template<typename V>
+		Iterator<V> iteratorAt(size_t index) const
+		{
+			return Iterator<V>(m_Control, m_Slots, index, m_Capacity);
+		}
+
+		/*
+			The value of key, or nullptr if it isn't in the table
+		*/
+		Value* find(const Key& key) const
+		{
+			if(m_Size == 0)
+			{
+				return nullptr;
+			}
+
+			const size_t hash = mixHash(m_Hash(key));
+			const uint8_t tag = tagOf(hash);
+
+			for(size_t index = hash & (m_Capacity - 1);m_Control[index] != Empty;index = (index + 1) & (m_Capacity - 1))
+			{
+				if(m_Control[index] == tag && m_Equal(KeyOf::key(m_Slots[index]), key))
+				{
+					return m_Slots + index;
+				}
+			}
+
+			return nullptr;
+		}
+
+		/*
+			Constructs a value from key and args with KeyOf::construct(), unless key is in the table already.
+			Returns the value of key, and whether it was inserted
+		*/
+		template<typename K, typename... Args>
+		std::pair<Value*, bool> emplaceKey(K&& key, Args&&... args)
+		{
+			Value* found = find(key);
+			if(found != nullptr)
+			{
+				return {found, false};
+			}
+
+			if((m_Size + 1) * MaxLoadDenominator > m_Capacity * MaxLoadNumerator)
+			{
+				rehash(m_Capacity == 0 ? m_InitialCapacity : m_Capacity * 2, m_Resource);
+			}
+
+			const size_t hash = mixHash(m_Hash(std::as_const(key)));
+
+			size_t index = hash & (m_Capacity - 1);
+			while(m_Control[index] != Empty)
+			{
+				index = (index + 1) & (m_Capacity - 1);
+			}
+
+			KeyOf::construct(m_Slots + index, std::forward<K>(key), std::forward<Args>(args)...);
+			m_Control[index] = tagOf(hash);
+			m_Size++;
+			return {m_Slots + index, true};
+		}
+
+		/*
+			Builds a table of capacity slots allocated from resource holding the values, then swaps it with this one.
+			If a value throws while copied into it, the new table is destroyed and this one is left untouched
+		*/
+		void rehash(size_t capacity, std::pmr::memory_resource* resource)
+		{
+			FlatHashTable table(0, m_Hash, m_Equal);
+			table.m_Resource = resource;
+			table.allocate(capacity);
+
+			for(size_t i = 0;i < m_Capacity;++i)
+			{
+				if(m_Control[i] != Empty)
+				{
+					const size_t hash = mixHash(m_Hash(KeyOf::key(m_Slots[i])));
+
+					size_t index = hash & (capacity - 1);
+					while(table.m_Control[index] != Empty)
+					{
+						index = (index + 1) & (capacity - 1);
+					}
+
+					new(table.m_Slots + index) Value(std::move_if_noexcept(m_Slots[i]));
+					table.m_Control[index] = m_Control[i];
+					table.m_Size++;
+				}
+			}
+
+			// The old values, moved from or not, are destroyed with the table swapped out
+			*this = std::move(table);
+		}
+
+		/*
+			Allocates the slots of an empty table holding no memory yet
+		*/
+		void allocate(size_t capacity)
+		{
+			m_Control = static_cast<uint8_t*>(m_Resource->allocate(capacity, alignof(uint8_t)));
+			std::fill(m_Control, m_Control + capacity, Empty);
+			m_Capacity = capacity;
+			m_Slots = static_cast<Value*>(m_Resource->allocate(capacity * sizeof(Value), alignof(Value)));
+		}
+
+		void deallocate()
+		{
+			if(m_Control != nullptr)
+			{
+				m_Resource->deallocate(m_Control, m_Capacity, alignof(uint8_t));
+				m_Control = nullptr;
+			}
+
+			if(m_Slots != nullptr)
+			{
+				m_Resource->deallocate(m_Slots, m_Capacity * sizeof(Value), alignof(Value));
+				m_Slots = nullptr;
+			}
+		}
+
+		/*
+			Control byte of an occupied slot: the top 7 bits of the hash, with the high bit set
+		*/
+		static uint8_t tagOf(size_t hash)
+		{
+			return static_cast<uint8_t>((hash >> (std::numeric_limits<size_t>::digits - 7)) | 0x80);
+		}
+
+	protected:
+		static constexpr uint8_t Empty = 0;
+		static constexpr size_t MinCapacity = 16;
+		static constexpr size_t MaxLoadNumerator = 7;
+		static constexpr size_t MaxLoadDenominator = 8;
+
+		Hash m_Hash;
+		Equal m_Equal;
+		std::pmr::memory_resource* m_Resource = std::pmr::get_default_resource();
+		uint8_t* m_Control = nullptr;
+		Value* m_Slots = nullptr;
+		size_t m_Capacity = 0;
+		size_t m_Size = 0;
+		size_t m_InitialCapacity = MinCapacity;
+	};
+
+
+	template<typename T>
+	struct SetKeyOf
+	{
+		static const T& key(const T& value)
+		{
+			return value;
+		}
+
+		template<typename K>
+		static void construct(T* slot, K&& key)
+		{
+			new(slot) T(std::forward<K>(key));
+		}
+	};
+
+	/*
+		Hash set used by distinct(), see FlatHashTable
+
+		==> T: the type of the elements
+		==> Hash: hash function of the elements
+		==> Equal: equality of the elements, consistent with Hash
+
+	*/
+	template<typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+	class FlatHashSet : public FlatHashTable<T, T, SetKeyOf<T>, Hash, Equal>
+	{
+		using Table = FlatHashTable<T, T, SetKeyOf<T>, Hash, Equal>;
+	public:
+		using iterator = typename Table::template Iterator<const T>;
+		using const_iterator = iterator;
+
+		/*
+			Creates an empty set able to hold expectedSize elements without growing
+		*/
+		explicit FlatHashSet(size_t expectedSize = 0, Hash hash = Hash(), Equal equal = Equal())
+			: Table(expectedSize, std::move(hash), std::move(equal))
+		{
+
+		}
+
+		/*
+			Inserts a copy of element if it isn't in the set yet.
+			Returns the element in the set, and whether it was inserted
+		*/
+		std::pair<const T*, bool> insert(const T& element)
+		{
+			return this->emplaceKey(element);
+		}
+
+		std::pair<const T*, bool> insert(T&& element)
+		{
+			return this->emplaceKey(std::move(element));
+		}
+
+		iterator begin() const
+		{
+			return this->template iteratorAt<const T>(0);
+		}
+
+		iterator end() const
+		{
+			return this->template iteratorAt<const T>(this->m_Capacity);
+		}
+	};
+
+
+	template<typename K, typename V>
+	struct MapKeyOf
+	{
+		static const K& key(const std::pair<K, V>& value)
+		{
+			return value.first;
+		}
+
+		template<typename Key, typename... Args>
+		static void construct(std::pair<K, V>* slot, Key&& key, Args&&... args)
+		{
+			new(slot) std::pair<K, V>(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+	};
+
+	/*
+		Hash map used by the grouping collectors, see FlatHashTable.
+		The keys of its pairs must not be modified
+
+		==> K: the type of the keys
+		==> V: the type of the mapped values
+		==> Hash: hash function of the keys
+		==> Equal: equality of the keys, consistent with Hash
+
+	*/
+	template<typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+	class FlatHashMap : public FlatHashTable<K, std::pair<K, V>, MapKeyOf<K, V>, Hash, Equal>
+	{
+		using Table = FlatHashTable<K, std::pair<K, V>, MapKeyOf<K, V>, Hash, Equal>;
+	public:
+		using mapped_type = V;
+		using iterator = typename Table::template Iterator<std::pair<K, V>>;
+		using const_iterator = typename Table::template Iterator<const std::pair<K, V>>;
+
+		/*
+			Creates an empty map able to hold expectedSize keys without growing
+		*/
+		explicit FlatHashMap(size_t expectedSize = 0, Hash hash = Hash(), Equal equal = Equal())
+			: Table(expectedSize, std::move(hash), std::move(equal))
+		{
+
+		}
+
+		/*
+			Inserts key with a value constructed from args if it isn't in the map yet.
+			Returns the pair of key, and whether it was inserted
+		*/
+		template<typename Key, typename... Args>
+		std::pair<std::pair<K, V>*, bool> tryEmplace(Key&& key, Args&&... args)
+		{
+			return this->emplaceKey(std::forward<Key>(key), std::forward<Args>(args)...);
+		}
+
+		V& operator[](const K& key)
+		{
+			return tryEmplace(key).first->second;
+		}
+
+		V& operator[](K&& key)
+		{
+			return tryEmplace(std::move(key)).first->second;
+		}
+
+		/*
+			The value of key, or nullptr if it isn't in the map
+		*/
+		V* get(const K& key)
+		{
+			std::pair<K, V>* found = this->find(key);
+			return found == nullptr ? nullptr : &found->second;
+		}
+
+		const V* get(const K& key) const
+		{
+			const std::pair<K, V>* found = this->find(key);
+			return found == nullptr ? nullptr : &found->second;
+		}
+
+		iterator begin()
+		{
+			return this->template iteratorAt<std::pair<K, V>>(0);
+		}
+
+		iterator end()
+		{
+			return this->template iteratorAt<std::pair<K, V>>(this->m_Capacity);
+		}
+
+		const_iterator begin() const
+		{
+			return this->template iteratorAt<const std::pair<K, V>>(0);
+		}
+
+		const_iterator end() const
+		{
+			return this->template iteratorAt<const std::pair<K, V>>(this->m_Capacity);
+		}
+	};
+
+// ===============================================================================================================================
+
+
+	// ===> SKETCHES <===
+
+
+	/*
+		Finalizer of splitmix64. Unlike mixHash(), every bit of the result depends on every bit
+		of the hash, which probabilistic sketches need since they use all of them
+	*/
+	inline uint64_t finalizeHash(uint64_t hash)
+	{
+		hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+		hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+		return hash ^ (hash >> 31);
+	}
+
+	/*
+		HyperLogLog cardinality estimator, used by countDistinctApprox()
+
+		Counts the distinct hashes added to it in 2^precision bytes, whatever their number.
+		The standard error of the estimate is about 1.04 / sqrt(2^precision), e.g. 0.8% with
+		the default precision of 14 (16KB). Sketches of the same precision can be merged,
+		so each chunk of a parallel stream fills its own one
+
+	*/
+	class HyperLogLog
+	{
+	public:
+
+		/*
+			Creates an empty sketch. Precision must be between 4 and 18
+		*/
+		explicit HyperLogLog(unsigned precision = 14)
+			: m_Precision(checkPrecision(precision)), m_Registers(size_t(1) << precision, 0)
+		{
+
+		}
+
+		void add(size_t hash)
+		{
+			const uint64_t mixed = finalizeHash(hash);
+			const size_t index = static_cast<size_t>(mixed >> (64 - m_Precision));
+
+			// Rank of the first set bit among the remaining 64 - precision bits
+			uint8_t rank = 1;
+			for(uint64_t bits = mixed << m_Precision;(bits & (uint64_t(1) << 63)) == 0 && rank <= 64 - m_Precision;bits <<= 1)
+			{
+				rank++;
+			}
+
+			m_Registers[index] = std::max(m_Registers[index], rank);
+		}
+
+		/*
+			Adds the hashes of other into this sketch. Both must have the same precision
+		*/
+		void merge(const HyperLogLog& other)
+		{
+			if(other.m_Precision != m_Precision)
+			{
+				throw std::invalid_argument("Cannot merge HyperLogLog sketches of different precisions");
+			}
+
+			for(size_t i = 0;i < m_Registers.size();++i)
+			{
+				m_Registers[i] = std::max(m_Registers[i], other.m_Registers[i]);
+			}
+		}
+
+		/*
+			Estimated number of distinct hashes added
+		*/
+		size_t estimate() const
+		{
+			const double registers = static_cast<double>(m_Registers.size());
+
+			double sum = 0;
+			size_t zeros = 0;
+			for(uint8_t rank : m_Registers)
+			{
+				sum += std::ldexp(1.0, -rank);
+				zeros += rank == 0 ? 1 : 0;
+			}
+
+			double estimate = alpha() * registers * registers / sum;
+
+			// Small cardinalities are estimated better by linear counting
+			if(estimate <= 2.5 * registers && zeros > 0)
+			{
+				estimate = registers * std::log(registers / static_cast<double>(zeros));
+			}
+
+			return static_cast<size_t>(std::llround(estimate));
+		}
+
+		/*
+			Standard error of estimate(), relative to the actual count
+		*/
+		double relativeError() const
+		{
+			return 1.04 / std::sqrt(static_cast<double>(m_Registers.size()));
+		}
+
+		unsigned precision() const
+		{
+			return m_Precision;
+		}
+
+	private:
+
+		static unsigned checkPrecision(unsigned precision)
+		{
+			if(precision < 4 || precision > 18)
+			{
+				throw std::invalid_argument("HyperLogLog precision must be between 4 and 18");
+			}
+
+			return precision;
+		}
+
+		double alpha() const
+		{
+			switch(m_Precision)
+			{
+				case 4: return 0.673;
+				case 5: return 0.697;
+				case 6: return 0.709;
+				default: return 0.7213 / (1.0 + 1.079 / static_cast<double>(m_Registers.size()));
+			}
+		}
+
+	private:
+		unsigned m_Precision;
+		std::vector<uint8_t> m_Registers;
+	};
+
+	/*
+		Bloom filter of a fixed number of bits, used by distinctApprox()
+
+		After n insertions into a filter of m bits with k hash functions, an element never
+		inserted is reported as present with a probability of about (1 - e^(-k * n / m))^k,
+		see falsePositiveRate(). For a given m and expected n, k = m / n * ln(2) minimizes it,
+		e.g. 10 bits per element and 7 hashes give about 0.8%. Elements inserted are always reported
+		as present. Filters of the same size and number of hashes can be merged
+
+		==> T: the type of the elements
+		==> Hash: hash function of the elements
+
+	*/
+	template<typename T, typename Hash = std::hash<T>>
+	class BloomFilter
+	{
+	public:
+
+		BloomFilter(size_t bits, unsigned hashes = 7, Hash hash = Hash())
+			: m_Bits(bits), m_Hashes(hashes), m_Hash(std::move(hash)), m_Words((bits + 63) / 64, 0)
+		{
+			if(bits == 0 || hashes == 0)
+			{
+				throw std::invalid_argument("A Bloom filter needs at least one bit and one hash function");
+			}
+		}
+
+		/*
+			Sets the bits of element. Like the insert() of a set, the second member of the result
+			is whether the element was new, i.e. whether one of its bits wasn't set yet. No element
+			is stored, so the first member is always nullptr
+		*/
+		std::pair<const T*, bool> insert(const T& element)
+		{
+			bool inserted = false;
+
+			forEachBit(element, [&](size_t bit)
+			{
+				uint64_t& word = m_Words[bit / 64];
+				const uint64_t mask = uint64_t(1) << (bit % 64);
+				inserted |= (word & mask) == 0;
+				word |= mask;
+			});
+
+			return {nullptr, inserted};
+		}
+
+		bool mightContain(const T& element) const
+		{
+			bool contained = true;
+
+			forEachBit(element, [&](size_t bit)
+			{
+				contained &= (m_Words[bit / 64] & (uint64_t(1) << (bit % 64))) != 0;
+			});
+
+			return contained;
+		}
+
+		/*
+			Unsets every bit, keeping the memory of the filter
+		*/
+		void clear()
+		{
+			std::fill(m_Words.begin(), m_Words.end(), 0);
+		}
+
+		/*
+			Adds the elements of other into this filter. Both must have the same bits and hashes
+		*/
+		void merge(const BloomFilter& other)
+		{
+			if(other.m_Bits != m_Bits || other.m_Hashes != m_Hashes)
+			{
+				throw std::invalid_argument("Cannot merge Bloom filters of different sizes");
+			}
+
+			for(size_t i = 0;i < m_Words.size();++i)
+			{
+				m_Words[i] |= other.m_Words[i];
+			}
+		}
+
+		/*
+			Probability that an element never inserted is reported as present,
+			after inserting insertedCount elements into a filter of bits and hashes
+		*/
+		static double falsePositiveRate(size_t bits, unsigned hashes, size_t insertedCount)
+		{
+			const double k = static_cast<double>(hashes);
+			return std::pow(1.0 - std::exp(-k * static_cast<double>(insertedCount) / static_cast<double>(bits)), k);
+		}
+
+		size_t bits() const
+		{
+			return m_Bits;
+		}
+
+		unsigned hashes() const
+		{
+			return m_Hashes;
+		}
+
+	private:
+
+		/*
+			Derives the bits of element from two hashes, as h1 + i * h2 (Kirsch and Mitzenmacher)
+		*/
+		template<typename Action>
+		void forEachBit(const T& element, Action action) const
+		{
+			const uint64_t h1 = finalizeHash(m_Hash(element));
+			const uint64_t h2 = finalizeHash(h1) | 1;
+
+			for(unsigned i = 0;i < m_Hashes;++i)
+			{
+				action(static_cast<size_t>((h1 + i * h2) % m_Bits));
+			}
+		}
+
+	private:
+		size_t m_Bits;
+		unsigned m_Hashes;
+		Hash m_Hash;
+		std::vector<uint64_t> m_Words;
+	};
+
+	/*
+		Merging t-digest (Dunning), estimating the quantiles of the values added to it, used by quantilesApprox()
+
+		The values are summarized by centroids, i.e. weighted means, which are small near the median and
+		smaller still near the tails, so extreme quantiles like 0.99 or 0.001 stay accurate. The number of
+		centroids is about compression, whatever the number of values. A higher compression is more
+		accurate and takes more memory, 100 is typically within 1% of the rank of the exact quantile.
+		Digests can be merged, so each chunk of a parallel stream fills its own one
+
+		The values added are buffered and merged into the centroids in batches, also when querying
+		a quantile, which is why a digest cannot be queried from several threads
+	*/
+	class TDigest
+	{
+	public:
+
+		/*
+			Creates an empty digest. Compression must be at least 10
+		*/
+		explicit TDigest(double compression = 100)
+			: m_Compression(checkCompression(compression)), m_BufferSize(static_cast<size_t>(compression) * 5)
+		{
+
+		}
+
+		void add(double value)
+		{
+			if(std::isnan(value))
+			{
+				return;
+			}
+
+			if(m_Count == 0 || value < m_Min)
+			{
+				m_Min = value;
+			}
+			if(m_Count == 0 || value > m_Max)
+			{
+				m_Max = value;
+			}
+
+			m_Buffer.push_back(Centroid{value, 1});
+			++m_Count;
+
+			if(m_Buffer.size() >= m_BufferSize)
+			{
+				compress();
+			}
+		}
+
+		/*
+			Adds the values of other into this digest. Digests of different compressions can be merged,
+			the result has the compression of this one
+		*/
+		void merge(const TDigest& other)
+		{
+			if(other.m_Count == 0)
+			{
+				return;
+			}
+
+			m_Min = m_Count == 0 ? other.m_Min : std::min(m_Min, other.m_Min);
+			m_Max = m_Count == 0 ? other.m_Max : std::max(m_Max, other.m_Max);
+			m_Count += other.m_Count;
+
+			m_Buffer.insert(m_Buffer.end(), other.m_Centroids.begin(), other.m_Centroids.end());
+			m_Buffer.insert(m_Buffer.end(), other.m_Buffer.begin(), other.m_Buffer.end());
+			compress();
+		}
+
+		/*
+			Estimated value below which the fraction q of the values lie, between 0 and 1, or nothing
+			if no value was added. quantile(0) and quantile(1) are the exact minimum and maximum
+		*/
+		Optional<double> quantile(double q)
+		{
+			if(m_Count == 0)
+			{
+				return {};
+			}
+
+			compress();
+
+			q = std::clamp(q, 0.0, 1.0);
+			const double rank = q * static_cast<double>(m_Count);
+
+			const Centroid& first = m_Centroids.front();
+			const Centroid& last = m_Centroids.back();
+
+			// The values of the first and last half centroids spread from the minimum and to the maximum
+			if(rank < first.weight / 2)
+			{
+				return m_Min + (first.mean - m_Min) * rank / (first.weight / 2);
+			}
+			if(rank > static_cast<double>(m_Count) - last.weight / 2)
+			{
+				return last.mean + (m_Max - last.mean) * (rank - (static_cast<double>(m_Count) - last.weight / 2)) / (last.weight / 2);
+			}
+
+			// Otherwise interpolates between the centers of the two centroids around rank
+			double center = first.weight / 2;
+
+			for(size_t i = 0;i + 1 < m_Centroids.size();++i)
+			{
+				const Centroid& left = m_Centroids[i];
+				const Centroid& right = m_Centroids[i + 1];
+				const double gap = (left.weight + right.weight) / 2;
+
+				if(rank <= center + gap)
+				{
+					return left.mean + (right.mean - left.mean) * (rank - center) / gap;
+				}
+
+				center += gap;
+			}
+
+			return last.mean;
+		}
+
+		/*
+			Number of values added
+		*/
+		size_t count() const
+		{
+			return m_Count;
+		}
+
+		double compression() const
+		{
+			return m_Compression;
+		}
+
+	private:
+
+		struct Centroid
+		{
+			double mean;
+			double weight;
+		};
+
+		static double checkCompression(double compression)
+		{
+			if(!(compression >= 10))
+			{
+				throw std::invalid_argument("TDigest compression must be at least 10");
+			}
+
+			return compression;
+		}
+
+		/*
+			Scale function k1, in which no centroid spans more than 1: centroids cover
+			fewer values as the quantile q gets closer to 0 or 1
+		*/
+		double scale(double q) const
+		{
+			constexpr double Pi = 3.14159265358979323846;
+			return m_Compression / (2 * Pi) * std::asin(2 * std::clamp(q, 0.0, 1.0) - 1);
+		}
+
+		/*
+			Merges the buffered values into the centroids
+		*/
+		void compress()
+		{
+			if(m_Buffer.empty())
+			{
+				return;
+			}
+
+			m_Buffer.insert(m_Buffer.end(), m_Centroids.begin(), m_Centroids.end());
+			std::sort(m_Buffer.begin(), m_Buffer.end(), [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+			const double total = static_cast<double>(m_Count);
+
+			m_Centroids.clear();
+			m_Centroids.push_back(m_Buffer.front());
+
+			double before = 0;
+			double limit = scale(0) + 1;
+
+			for(size_t i = 1;i < m_Buffer.size();++i)
+			{
+				Centroid& current = m_Centroids.back();
+				const Centroid& next = m_Buffer[i];
+
+				if(scale((before + current.weight + next.weight) / total) <= limit)
+				{
+					current.weight += next.weight;
+					current.mean += (next.mean - current.mean) * next.weight / current.weight;
+				}
+				else
+				{
+					before += current.weight;
+					limit = scale(before / total) + 1;
+					m_Centroids.push_back(next);
+				}
+			}
+
+			m_Buffer.clear();
+		}
+
+	private:
+		double m_Compression;
+		size_t m_BufferSize;
+		size_t m_Count = 0;
+		double m_Min = 0;
+		double m_Max = 0;
+		std::vector<Centroid> m_Centroids;
+		std::vector<Centroid> m_Buffer;
+	};
+
+// ===============================================================================================================================
+
+
+	// ===> STATISTICS <===
+
+
+	/*
+		Count, sum, minimum, maximum, mean and variance of arithmetic values, computed in a single pass
+		by summaryStatistics()
+
+		The sum of integers is exact in 64 bits, and the sum of floating-point values is compensated
+		(Kahan-Babuska), so its error does not grow with the number of values. The mean and variance
+		are updated with Welford's algorithm, which does not cancel out like the sum of squares.
+		Statistics can be merged (Chan et al.), so each chunk of a parallel stream fills its own one
+
+		==> T: the type of the values
+	*/
+	template<typename T>
+	class SummaryStatistics
+	{
+		static_assert(std::is_arithmetic_v<T>, "Summary statistics are computed over arithmetic values");
+
+	public:
+		using Sum = std::conditional_t<std::is_floating_point_v<T>, std::common_type_t<T, double>,
+			std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+		void add(T value)
+		{
+			++m_Count;
+			addToSum(static_cast<Sum>(value));
+
+			if(m_Count == 1)
+			{
+				m_Min = value;
+				m_Max = value;
+			}
+			else
+			{
+				m_Min = value < m_Min ? value : m_Min;
+				m_Max = value > m_Max ? value : m_Max;
+			}
+
+			const double delta = static_cast<double>(value) - m_Mean;
+			m_Mean += delta / static_cast<double>(m_Count);
+			m_M2 += delta * (static_cast<double>(value) - m_Mean);
+		}
+
+		/*
+			Adds values[0, size) block by block: the compensated sum, the mean and the variance of each
+			block are computed in two passes with the SIMD kernels, while it is in cache, then merged into
+			these ones. Floating-point values are only vectorized with reassociate, see kernels
+		*/
+		void addAll(const T* values, size_t size, bool reassociate = false)
+		{
+			for(size_t begin = 0;begin < size;begin += BlockSize)
+			{
+				const T* block = values + begin;
+				const size_t count = std::min(BlockSize, size - begin);
+
+				SummaryStatistics partial;
+				partial.m_Count = count;
+				if constexpr(std::is_floating_point_v<Sum>)
+				{
+					std::tie(partial.m_Sum, partial.m_Compensation) = kernels::compensatedSum<Sum>(block, count, reassociate);
+				}
+				else
+				{
+					partial.m_Sum = kernels::sum(block, count, Sum(), reassociate);
+				}
+
+				partial.m_Min = kernels::extreme<true>(block, count, reassociate);
+				partial.m_Max = kernels::extreme<false>(block, count, reassociate);
+
+				const double mean = static_cast<double>(partial.sum()) / static_cast<double>(count);
+				const auto [squares, deviations] = kernels::deviations(block, count, mean, reassociate);
+				partial.m_Mean = mean + deviations / static_cast<double>(count);
+				partial.m_M2 = squares - deviations * deviations / static_cast<double>(count);
+
+				merge(partial);
+			}
+		}
+
+		/*
+			Adds the values of other into these statistics
+		*/
+		void merge(const SummaryStatistics& other)
+		{
+			if(other.m_Count == 0)
+			{
+				return;
+			}
+
+			if(m_Count == 0)
+			{
+				*this = other;
+				return;
+			}
+
+			const double count = static_cast<double>(m_Count + other.m_Count);
+			const double delta = other.m_Mean - m_Mean;
+
+			m_Mean += delta * static_cast<double>(other.m_Count) / count;
+			m_M2 += other.m_M2 + delta * delta * (static_cast<double>(m_Count) * static_cast<double>(other.m_Count) / count);
+			m_Count += other.m_Count;
+
+			addToSum(other.m_Sum);
+			addToSum(other.m_Compensation);
+
+			m_Min = other.m_Min < m_Min ? other.m_Min : m_Min;
+			m_Max = other.m_Max > m_Max ? other.m_Max : m_Max;
+		}
+
+		size_t count() const
+		{
+			return m_Count;
+		}
+
+		Sum sum() const
+		{
+			return m_Sum + m_Compensation;
+		}
+
+		Optional<T> min() const
+		{
+			return m_Count == 0 ? Optional<T>() : Optional<T>(m_Min);
+		}
+
+		Optional<T> max() const
+		{
+			return m_Count == 0 ? Optional<T>() : Optional<T>(m_Max);
+		}
+
+		Optional<double> mean() const
+		{
+			return m_Count == 0 ? Optional<double>() : Optional<double>(m_Mean);
+		}
+
+		/*
+			Population variance, i.e. the mean of the squared deviations from the mean
+		*/
+		Optional<double> variance() const
+		{
+			return m_Count == 0 ? Optional<double>() : Optional<double>(m_M2 / static_cast<double>(m_Count));
+		}
+
+		/*
+			Unbiased variance of a sample, dividing by count - 1. Empty below 2 values
+		*/
+		Optional<double> sampleVariance() const
+		{
+			return m_Count < 2 ? Optional<double>() : Optional<double>(m_M2 / static_cast<double>(m_Count - 1));
+		}
+
+		/*
+			Population standard deviation
+		*/
+		Optional<double> standardDeviation() const
+		{
+			return m_Count == 0 ? Optional<double>() : Optional<double>(std::sqrt(m_M2 / static_cast<double>(m_Count)));
+		}
+
+	private:
+		static constexpr size_t BlockSize = 1024;
+
+		void addToSum(Sum value)
+		{
+			if constexpr(std::is_floating_point_v<Sum>)
+			{
+				kernels::addCompensated(m_Sum, m_Compensation, value);
+			}
+			else
+			{
+				m_Sum += value;
+			}
+		}
+
+	private:
+		size_t m_Count = 0;
+		Sum m_Sum = Sum();
+		Sum m_Compensation = Sum();
+		T m_Min = T();
+		T m_Max = T();
+		double m_Mean = 0;
+		double m_M2 = 0;
+	};
+
+// ===============================================================================================================================
+
+
+	// ===> COLLECTORS <===
+
+
+	/*
+		Built-in collectors, passed to Stream::collect(), e.g.
+
+			stream::of(people).collect(collectors::groupingBy(&Person::city, collectors::counting()))
+
+		Each function returns a collector factory: Stream::collect() binds it to the type T of the elements
+		of the stream with factory.bind<T>(), which returns the actual collector. Collectors
+		aggregate the elements as they come, without storing them unless asked to, and all of
+		them can be combined, so they are also able to collect in parallel
+	*/
+	namespace collectors
+	{
+
+		struct Identity
+		{
+			template<typename E>
+			E&& operator()(E&& element) const
+			{
+				return std::forward<E>(element);
+			}
+		};
+
+		/*
+			Result of invoking Function on the elements of type T
+		*/
+		template<typename Function, typename T>
+		using ResultOf = std::decay_t<std::invoke_result_t<const Function&, const T&>>;
+
+		template<typename Container>
+		struct ToContainer
+		{
+			template<typename T>
+			struct Collector
+			{
+				using ContainerType = Container;
+
+				Container m_Container;
+
+				template<typename E>
+				void insert(E&& element)
+				{
+					m_Container.insert(std::end(m_Container), std::forward<E>(element));
+				}
+
+				void combine(Collector&& other)
+				{
+					for(auto& element : other.m_Container)
+					{
+						m_Container.insert(std::end(m_Container), std::move(element));
+					}
+				}
+
+				Container operator*()
+				{
+					return std::move(m_Container);
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>{Container()};
+			}
+		};
+
+		struct ToVector
+		{
+			template<typename T>
+			auto bind() const
+			{
+				return ToContainer<std::vector<T>>().template bind<T>();
+			}
+		};
+
+		struct Counting
+		{
+			template<typename T>
+			struct Collector
+			{
+				using ContainerType = size_t;
+
+				size_t m_Count = 0;
+
+				template<typename E>
+				void insert(E&&)
+				{
+					++m_Count;
+				}
+
+				void combine(Collector&& other)
+				{
+					m_Count += other.m_Count;
+				}
+
+				size_t operator*()
+				{
+					return m_Count;
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>();
+			}
+		};
+
+		template<typename Mapper>
+		struct Summing
+		{
+			Mapper m_Mapper;
+
+			template<typename T>
+			struct Collector
+			{
+				using ContainerType = ResultOf<Mapper, T>;
+
+				Mapper m_Mapper;
+				ContainerType m_Sum = ContainerType();
+
+				template<typename E>
+				void insert(E&& element)
+				{
+					m_Sum += std::invoke(m_Mapper, std::as_const(element));
+				}
+
+				void combine(Collector&& other)
+				{
+					m_Sum += other.m_Sum;
+				}
+
+				ContainerType operator*()
+				{
+					return m_Sum;
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>{m_Mapper};
+			}
+		};
+
+		template<typename Mapper>
+		struct Averaging
+		{
+			Mapper m_Mapper;
+
+			template<typename T>
+			struct Collector
+			{
+				using ContainerType = Optional<double>;
+
+				Mapper m_Mapper;
+				double m_Sum = 0;
+				size_t m_Count = 0;
+
+				template<typename E>
+				void insert(E&& element)
+				{
+					m_Sum += static_cast<double>(std::invoke(m_Mapper, std::as_const(element)));
+					++m_Count;
+				}
+
+				void combine(Collector&& other)
+				{
+					m_Sum += other.m_Sum;
+					m_Count += other.m_Count;
+				}
+
+				ContainerType operator*()
+				{
+					return m_Count == 0 ? ContainerType() : ContainerType(m_Sum / static_cast<double>(m_Count));
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>{m_Mapper};
+			}
+		};
+
+		struct Summarizing
+		{
+			template<typename T>
+			struct Collector
+			{
+				using ContainerType = SummaryStatistics<T>;
+
+				SummaryStatistics<T> m_Statistics;
+
+				void insert(const T& element)
+				{
+					m_Statistics.add(element);
+				}
+
+				void combine(Collector&& other)
+				{
+					m_Statistics.merge(other.m_Statistics);
+				}
+
+				ContainerType operator*()
+				{
+					return m_Statistics;
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return {};
+			}
+		};
+
+		template<typename Accumulate>
+		struct Reducing
+		{
+			Accumulate m_Accumulator;
+
+			template<typename T>
+			struct Collector
+			{
+				using ContainerType = Optional<T>;
+
+				Accumulate m_Accumulator;
+				Optional<T> m_Result;
+
+				template<typename E>
+				void insert(E&& element)
+				{
+					if(m_Result.has_value())
+					{
+						m_Result = m_Accumulator(std::move(m_Result.value()), std::forward<E>(element));
+					}
+					else
+					{
+						m_Result.emplace(std::forward<E>(element));
+					}
+				}
+
+				void combine(Collector&& other)
+				{
+					if(other.m_Result.has_value())
+					{
+						insert(std::move(other.m_Result.value()));
+					}
+				}
+
+				ContainerType operator*()
+				{
+					return m_Result;
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>{m_Accumulator, Optional<T>()};
+			}
+		};
+
+		struct Greater
+		{
+			template<typename E>
+			E operator()(E first, E second) const
+			{
+				return first < second ? std::move(second) : std::move(first);
+			}
+		};
+
+		struct Lesser
+		{
+			template<typename E>
+			E operator()(E first, E second) const
+			{
+				return second < first ? std::move(second) : std::move(first);
+			}
+		};
+
+		template<typename C, typename = void>
+		struct IsCombinable : std::false_type
+		{
+
+		};
+
+		template<typename C>
+		struct IsCombinable<C, std::void_t<decltype(std::declval<C&>().combine(std::declval<C&&>()))>> : std::true_type
+		{
+
+		};
+
+		template<typename Factory, typename T, typename = void>
+		struct IsFactory : std::false_type
+		{
+
+		};
+
+		template<typename Factory, typename T>
+		struct IsFactory<Factory, T, std::void_t<decltype(std::declval<const Factory&>().template bind<T>())>> : std::true_type
+		{
+
+		};
+
+		template<typename KeyFunction, typename Downstream>
+		struct GroupingBy
+		{
+			KeyFunction m_KeyFunction;
+			Downstream m_Downstream;
+
+			template<typename T>
+			struct Collector
+			{
+				using Key = ResultOf<KeyFunction, T>;
+				using Group = decltype(std::declval<const Downstream&>().template bind<T>());
+				using ContainerType = FlatHashMap<Key, typename Group::ContainerType>;
+
+				KeyFunction m_KeyFunction;
+				Downstream m_Downstream;
+				FlatHashMap<Key, Group> m_Groups;
+
+				template<typename E>
+				void insert(E&& element)
+				{
+					auto group = m_Groups.tryEmplace(std::invoke(m_KeyFunction, std::as_const(element)), GroupFactory{&m_Downstream}).first;
+					group->second.insert(std::forward<E>(element));
+				}
+
+				template<typename G = Group, typename = std::enable_if_t<IsCombinable<G>::value>>
+				void combine(Collector&& other)
+				{
+					for(auto& group : other.m_Groups)
+					{
+						auto inserted = m_Groups.tryEmplace(std::move(group.first), std::move(group.second));
+						if(!inserted.second)
+						{
+							inserted.first->second.combine(std::move(group.second));
+						}
+					}
+				}
+
+				ContainerType operator*()
+				{
+					ContainerType groups(m_Groups.size());
+
+					for(auto& group : m_Groups)
+					{
+						groups.tryEmplace(std::move(group.first), *group.second);
+					}
+
+					return groups;
+				}
+
+			private:
+
+				/*
+					Creates the collector of a new group in place, so it is never copied
+				*/
+				struct GroupFactory
+				{
+					const Downstream* m_Downstream;
+
+					operator Group() const
+					{
+						return m_Downstream->template bind<T>();
+					}
+				};
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>{m_KeyFunction, m_Downstream, FlatHashMap<typename Collector<T>::Key, typename Collector<T>::Group>()};
+			}
+		};
+
+		template<typename Condition, typename Downstream>
+		struct PartitioningBy
+		{
+			Condition m_Condition;
+			Downstream m_Downstream;
+
+			template<typename T>
+			struct Collector
+			{
+				using Part = decltype(std::declval<const Downstream&>().template bind<T>());
+				using ContainerType = std::pair<typename Part::ContainerType, typename Part::ContainerType>;
+
+				Condition m_Condition;
+				Part m_Matching;
+				Part m_Others;
+
+				template<typename E>
+				void insert(E&& element)
+				{
+					(std::invoke(m_Condition, std::as_const(element)) ? m_Matching : m_Others).insert(std::forward<E>(element));
+				}
+
+				template<typename P = Part, typename = std::enable_if_t<IsCombinable<P>::value>>
+				void combine(Collector&& other)
+				{
+					m_Matching.combine(std::move(other.m_Matching));
+					m_Others.combine(std::move(other.m_Others));
+				}
+
+				ContainerType operator*()
+				{
+					return ContainerType(*m_Matching, *m_Others);
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>{m_Condition, m_Downstream.template bind<T>(), m_Downstream.template bind<T>()};
+			}
+		};
+
+		/*
+			Merge function of toMap() used when none is given: duplicate keys are an error
+		*/
+		struct ThrowOnDuplicateKey
+		{
+			template<typename V>
+			V operator()(V&&, V&&) const
+			{
+				throw std::invalid_argument("Duplicate key in toMap()");
+			}
+		};
+
+		template<typename KeyFunction, typename ValueFunction, typename Merge>
+		struct ToMap
+		{
+			KeyFunction m_KeyFunction;
+			ValueFunction m_ValueFunction;
+			Merge m_Merge;
+
+			template<typename T>
+			struct Collector
+			{
+				using Key = ResultOf<KeyFunction, T>;
+				using Value = ResultOf<ValueFunction, T>;
+				using ContainerType = FlatHashMap<Key, Value>;
+
+				KeyFunction m_KeyFunction;
+				ValueFunction m_ValueFunction;
+				Merge m_Merge;
+				ContainerType m_Map;
+
+				template<typename E>
+				void insert(E&& element)
+				{
+					Key key = std::invoke(m_KeyFunction, std::as_const(element));
+					merge(std::move(key), Value(std::invoke(m_ValueFunction, std::forward<E>(element))));
+				}
+
+				void combine(Collector&& other)
+				{
+					for(auto& entry : other.m_Map)
+					{
+						merge(std::move(entry.first), std::move(entry.second));
+					}
+				}
+
+				ContainerType operator*()
+				{
+					return std::move(m_Map);
+				}
+
+			private:
+
+				void merge(Key&& key, Value&& value)
+				{
+					auto inserted = m_Map.tryEmplace(std::move(key), std::move(value));
+					if(!inserted.second)
+					{
+						inserted.first->second = m_Merge(std::move(inserted.first->second), std::move(value));
+					}
+				}
+			};
+
+			template<typename T>
+			Collector<T> bind() const
+			{
+				return Collector<T>{m_KeyFunction, m_ValueFunction, m_Merge, typename Collector<T>::ContainerType()};
+			}
+		};
+
+		/*
+			Collects the elements into a Container, using its insert(end, element) method
+		*/
+		template<typename Container>
+		ToContainer<Container> toContainer()
+		{
+			return {};
+		}
+
+		/*
+			Counts the elements
+		*/
+		inline Counting counting()
+		{
+			return {};
+		}
+
+		/*
+			Sums the results of mapper on the elements, or the elements themselves
+		*/
+		template<typename Mapper = Identity>
+		Summing<Mapper> summing(Mapper mapper = Mapper())
+		{
+			return {std::move(mapper)};
+		}
+
+		/*
+			Averages the results of mapper on the elements, or the elements themselves.
+			The result is empty if there are no elements
+		*/
+		template<typename Mapper = Identity>
+		Averaging<Mapper> averaging(Mapper mapper = Mapper())
+		{
+			return {std::move(mapper)};
+		}
+
+		/*
+			Count, sum, minimum, maximum, mean and variance of arithmetic elements, see SummaryStatistics
+		*/
+		inline Summarizing summarizing()
+		{
+			return {};
+		}
+
+		/*
+			Reduces the elements with accumulator(result, element), like Stream::reduce().
+			The result is empty if there are no elements
+		*/
+		template<typename Accumulate>
+		Reducing<Accumulate> reducing(Accumulate accumulator)
+		{
+			return {std::move(accumulator)};
+		}
+
+		/*
+			The greatest element, by operator<. The result is empty if there are no elements
+		*/
+		inline Reducing<Greater> maximum()
+		{
+			return {Greater()};
+		}
+
+		/*
+			The least element, by operator<. The result is empty if there are no elements
+		*/
+		inline Reducing<Lesser> minimum()
+		{
+			return {Lesser()};
+		}
+
+		/*
+			Groups the elements by their key in a FlatHashMap, collecting the elements of each group
+			with the downstream collector, e.g. counting(). Groups are aggregated as the elements come,
+			so only the state of the downstream collector of each group is kept.
+			keyFunction may also be a pointer to a member, like &Person::city
+		*/
+		template<typename KeyFunction, typename Downstream>
+		GroupingBy<KeyFunction, Downstream> groupingBy(KeyFunction keyFunction, Downstream downstream)
+		{
+			return {std::move(keyFunction), std::move(downstream)};
+		}
+
+		/*
+			Groups the elements by their key into a std::vector per group
+		*/
+		template<typename KeyFunction>
+		auto groupingBy(KeyFunction keyFunction)
+		{
+			return groupingBy(std::move(keyFunction), ToVector());
+		}
+
+		/*
+			Splits the elements into those matching condition, collected in the first member of
+			the result, and the others, collected in the second one, with the downstream collector
+		*/
+		template<typename Condition, typename Downstream>
+		PartitioningBy<Condition, Downstream> partitioningBy(Condition condition, Downstream downstream)
+		{
+			return {std::move(condition), std::move(downstream)};
+		}
+
+		template<typename Condition>
+		auto partitioningBy(Condition condition)
+		{
+			return partitioningBy(std::move(condition), ToVector());
+		}
+
+		/*
+			Maps each element to a key and a value in a FlatHashMap. The values of duplicate keys
+			are merged with merge(oldValue, newValue), or throw std::invalid_argument if no merge is given
+		*/
+		template<typename KeyFunction, typename ValueFunction, typename Merge = ThrowOnDuplicateKey>
+		ToMap<KeyFunction, ValueFunction, Merge> toMap(KeyFunction keyFunction, ValueFunction valueFunction, Merge merge = Merge())
+		{
+			return {std::move(keyFunction), std::move(valueFunction), std::move(merge)};
+		}
+	}
+
+// ===============================================================================================================================
+
+
+	// ===> AGGREGATORS <===
+
+
+	/*
+		Windows of an Aggregator. The elements are aggregated from the start of a window, and each
+		window starts over from an empty collector once the previous one is closed
+
+		==> size_t count: the number of elements of each window, or 0 if they are not closed by count
+		==> std::chrono::steady_clock::duration duration: how long each window lasts, or 0 if they are not closed by time
+	*/
+	struct Window
+	{
+		size_t count = 0;
+		std::chrono::steady_clock::duration duration{0};
+
+		/*
+			Windows of count consecutive elements. Throws std::invalid_argument if count is zero
+		*/
+		static Window tumbling(size_t count)
+		{
+			if(count == 0)
+			{
+				throw std::invalid_argument("A tumbling window needs at least one element");
+			}
+
+			return Window{count, std::chrono::steady_clock::duration(0)};
+		}
+
+		/*
+			Windows of the elements arriving in each period of the given duration, from the
+			creation of the aggregator on. Throws std::invalid_argument if duration is not positive
+		*/
+		template<typename Rep, typename Period>
+		static Window every(std::chrono::duration<Rep, Period> duration)
+		{
+			if(duration <= duration.zero())
+			{
+				throw std::invalid_argument("A time window needs a positive duration");
+			}
+
+			return Window{0, std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration)};
+		}
+	};
+
+	/*
+		Aggregates elements incrementally as they arrive, so the result so far can be read at any time,
+		e.g. running totals over a live feed:
+
+			auto totals = stream::aggregator<Order>(collectors::summing(&Order::amount), Window::every(std::chrono::seconds(1)));
+			std::thread feed([&]() { orders.aggregate(totals); });
+			...
+			double lastSecond = totals.lastWindow().value_or(0.0);
+
+		The elements are aggregated by a collector, like those of Stream::collect(), e.g.
+		collectors::counting(), averaging() or reducing(). Elements may be inserted by one thread,
+		through Stream::aggregate() or insert(), while others read snapshots: every operation
+		takes a lock, which is uncontended most of the time
+
+		==> T: the type of the elements
+		==> Factory: the collector factory, bound to T
+	*/
+	template<typename T, typename Factory>
+	class Aggregator
+	{
+	public:
+		using Collector = decltype(std::declval<const Factory&>().template bind<T>());
+		using Result = std::decay_t<decltype(*std::declval<Collector&>())>;
+
+		/*
+			==> Factory factory: the collector factory
+			==> Window window: when the windows are closed. By default, a single window holds every element
+			==> Consumer<Result> onWindow: called with the result of each window once it is closed,
+				by the thread closing it, without holding the lock
+		*/
+		explicit Aggregator(Factory factory, Window window = Window(), Consumer<Result> onWindow = nullptr)
+			: m_Factory(std::move(factory)), m_Window(window), m_OnWindow(std::move(onWindow)),
+			  m_WindowStart(std::chrono::steady_clock::now())
+		{
+			m_Collector.emplace(m_Factory.template bind<T>());
+		}
+
+		template<typename E>
+		void insert(E&& element)
+		{
+			Optional<Result> closed;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				closeExpiredWindow(closed);
+				m_Collector->insert(std::forward<E>(element));
+				++m_Count;
+
+				if(m_Window.count != 0 && m_Count == m_Window.count)
+				{
+					closeWindow(closed);
+				}
+			}
+
+			notify(closed);
+		}
+
+		/*
+			The result of the elements of the current window so far. The collector is copied,
+			so the aggregation goes on untouched
+		*/
+		Result snapshot()
+		{
+			Optional<Result> closed;
+			Optional<Result> result;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				closeExpiredWindow(closed);
+				Collector collector = m_Collector.value();
+				result.emplace(*collector);
+			}
+
+			notify(closed);
+			return std::move(result.value());
+		}
+
+		/*
+			The result of the last closed window, or nothing if no window was closed yet
+		*/
+		Optional<Result> lastWindow()
+		{
+			Optional<Result> closed;
+			Optional<Result> result;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				closeExpiredWindow(closed);
+				result = m_LastWindow;
+			}
+
+			notify(closed);
+			return result;
+		}
+
+		/*
+			The number of elements in the current window
+		*/
+		size_t count() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Count;
+		}
+
+		/*
+			The number of windows closed so far
+		*/
+		size_t windows() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Windows;
+		}
+
+		/*
+			Makes Stream::aggregate() return after its current element. Inserting elements is still possible
+		*/
+		void stop()
+		{
+			m_Stopped.store(true, std::memory_order_relaxed);
+		}
+
+		bool isStopped() const
+		{
+			return m_Stopped.load(std::memory_order_relaxed);
+		}
+
+		/*
+			Starts over with an empty window, forgetting the last window
+		*/
+		void reset()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_Collector.emplace(m_Factory.template bind<T>());
+			m_Count = 0;
+			m_Windows = 0;
+			m_LastWindow.reset();
+			m_WindowStart = std::chrono::steady_clock::now();
+			m_Stopped.store(false, std::memory_order_relaxed);
+		}
+
+	private:
+
+		/*
+			Closes the current window if its time is over. If several windows went by without
+			any element, only the first of them is closed and the others are skipped
+		*/
+		void closeExpiredWindow(Optional<Result>& closed)
+		{
+			if(m_Window.duration.count() > 0)
+			{
+				const auto now = std::chrono::steady_clock::now();
+				const auto elapsed = now - m_WindowStart;
+
+				if(elapsed >= m_Window.duration)
+				{
+					closeWindow(closed);
+					m_WindowStart += (elapsed / m_Window.duration) * m_Window.duration;
+				}
+			}
+		}
+
+		void closeWindow(Optional<Result>& closed)
+		{
+			m_LastWindow.emplace(**m_Collector);
+			m_Collector.emplace(m_Factory.template bind<T>());
+			m_Count = 0;
+			++m_Windows;
+
+			if(m_OnWindow)
+			{
+				closed = m_LastWindow;
+			}
+		}
+
+		void notify(Optional<Result>& closed)
+		{
+			if(closed.has_value())
+			{
+				m_OnWindow(std::move(closed.value()));
+			}
+		}
+
+	private:
+		Factory m_Factory;
+		Window m_Window;
+		Consumer<Result> m_OnWindow;
+
+		mutable std::mutex m_Mutex;
+		Optional<Collector> m_Collector;
+		size_t m_Count = 0;
+		size_t m_Windows = 0;
+		Optional<Result> m_LastWindow;
+		std::chrono::steady_clock::time_point m_WindowStart;
+		std::atomic<bool> m_Stopped{false};
+	};
+
+	/*
+		Creates an Aggregator of elements of type T, see Aggregator
+	*/
+	template<typename T, typename Factory>
+	Aggregator<T, Factory> aggregator(Factory factory, Window window = Window(), Consumer<typename Aggregator<T, Factory>::Result> onWindow = nullptr)
+	{
+		return Aggregator<T, Factory>(std::move(factory), window, std::move(onWindow));
+	}
+
+// ===============================================================================================================================
+
+
+	// ===> STREAM TYPES <===
+
+
+	/*
+		Base class for all streams
+
+		It provides a full interface for all possible operations with
+		streams. Subclasses of this class must implement its pipeline stage
+	
+		==> T: the type of the elements of this stream
+		==> Self: type of this stream object. This will serve as the source for the next stream in the pipeline
+	*/
+	template<typename T, typename Self>
+	class Stream;
+
+	/*
+		Only declared, to find the element type E of a stream in unevaluated contexts
+	*/
+	template<typename E, typename Self>
+	E streamElement(const Stream<E, Self>&);
+
+	template<typename S, typename = void>
+	struct IsStream : std::false_type
+	{
+
+	};
+
+	template<typename S>
+	struct IsStream<S, std::void_t<decltype(streamElement(std::declval<const S&>()))>> : std::true_type
+	{
+
+	};
+
+	/*
+		Elements of Range, which is either a stream or a range: those of the stream,
+		or the values of its iterators otherwise
+	*/
+	template<typename Range, bool = IsStream<Range>::value>
+	struct RangeElement
+	{
+		using Type = std::decay_t<decltype(*std::begin(std::declval<Range&>()))>;
+	};
+
+	template<typename Range>
+	struct RangeElement<Range, true>
+	{
+		using Type = decltype(streamElement(std::declval<const Range&>()));
+	};
+
+	/*
+		Result type of a flatMap operation: R if it was explicitly specified, or the elements
+		of the stream or range returned by FlatMapFunction when invoked with a T& otherwise
+	*/
+	template<typename R, typename T, typename FlatMapFunction>
+	using FlatMapResult = std::conditional_t<std::is_void_v<R>, typename RangeElement<std::invoke_result_t<FlatMapFunction&, T&>>::Type, R>;
+
+
+
+	/*
+		Stream that supplies elements from a collection of data. Elements
+		provided by this type of stream are not modified
+
+		Terminal operations pass elements down the pipeline by reference, and only copy
+		them where they have to be stored. Iterators yielding rvalues, like those of
+		stream::ofMove(), move the elements instead
+	
+		==> T: the type of the elements of this stream
+		==> Iterator: the iterator type of the data container
+
+	*/
+	template<typename T, typename Iterator>
+	class SourceStream;
+
+	
+	/*
+		Stream for filtering operations
+
+		It takes an element from the previous stream and evaluates it.
+		If the condition is true, the element will advance through the pipeline
+		to the next stream. If the condition is returns false, the element is discarded.
+	
+		==> Condition: the type of the predicate. Any callable type may be used,
+			so the compiler is able to inline it into the pipeline
+
+	*/
+	template<typename T, typename PreviousStream, typename Condition = Predicate<T>>
+	class FilterStream;
+
+
+	/*
+		Count of limit() and skip() given at runtime instead of as a template argument
+	*/
+	constexpr size_t DynamicSize = std::numeric_limits<size_t>::max();
+
+	/*
+		Stream for limiting operations
+
+		Consists of the elements in the previous stream truncated to be
+		no longer than MaxSize in length. If MaxSize is DynamicSize, the
+		maximum size is given to the constructor instead
+
+	*/
+	template<typename T, size_t MaxSize, typename PreviousStream>
+	class LimitStream;
+
+	/*
+	Stream for skipping operations
+
+	Skips the first N elements in the stream. If N is DynamicSize,
+	the number of elements skipped is given to the constructor instead
+
+	*/
+	template<typename T, size_t N, typename PreviousStream>
+	class SkipStream;
+
+	/*
+		Stream grouping the elements into chunks of N consecutive elements, the last chunk holding
+		the remaining ones. If N is DynamicSize, the size of the chunks is given to the
+		constructor instead
+
+		Each chunk is a Span over a buffer reused by every chunk, or over the source itself
+		if it is contiguous, so a chunk is only valid until the next one is passed on
+
+	*/
+	template<typename T, size_t N, typename PreviousStream>
+	class ChunkStream;
+
+	/*
+		Stream of the windows of the last N elements, moving one element at a time. If N is
+		DynamicSize, the size of the windows is given to the constructor instead
+
+		Each window is a Span over a ring buffer, or over the source itself if it is
+		contiguous, so a window is only valid until the next one is passed on.
+		Streams shorter than a window have no window
+
+	*/
+	template<typename T, size_t N, typename PreviousStream>
+	class SlidingStream;
+
+	/*
+		Stream for distinct operations
+
+		Discards the elements already seen in the stream. A copy of
+		each unique element is kept in a Set, so T must be copyable.
+		Sorted streams only keep the last unique element instead
+
+		==> Set: the set of the elements seen. It provides insert(element).second like std::unordered_set
+
+	*/
+	template<typename T, typename PreviousStream, typename Set = FlatHashSet<T>>
+	class DistinctStream;
+
+	/*
+		Stream for sorting operations
+
+		Buffers every element, then sorts them once the previous stream is exhausted.
+		When followed by limit<K>(), or by findFirst(), only the smallest K elements are
+		kept in a bounded heap, so sorting n elements takes O(n log K) time and O(K) memory.
+		Equal elements may come in any order
+
+		==> Less: strict weak ordering of the elements, like std::less<T>
+
+	*/
+	template<typename T, typename PreviousStream, typename Less = std::less<T>>
+	class SortedStream;
+
+	/*
+	
+		Stream for mapping operations
+
+		Maps each incoming element into another
+
+		==> MapFunction: the type of the mapping function. Any callable type may be used,
+			so the compiler is able to inline it into the pipeline
+	
+	*/
+	template<typename T, typename R, typename PreviuosStream, typename MapFunction = Function<T, R>>
+	class MapStream;
+
+	/*
+		Stream for flat mapping operations
+
+		Maps each incoming element into a stream or a range, whose elements are passed down
+		the pipeline in place of it. The inner stream or range is iterated lazily, without
+		being collected
+
+		==> FlatMapFunction: the type of the function returning the inner stream or range
+	*/
+	template<typename T, typename R, typename PreviousStream, typename FlatMapFunction>
+	class FlatMapStream;
+
+	template<typename T, typename Pipeline, typename RangeFunction>
+	struct InnerPipeline;
+
+	/*
+		Stream of the pairs of elements of two streams, taken in lockstep
+
+		It ends with the shorter of both streams. Each pair holds the elements
+		themselves, as the streams pass them, without any intermediate storage
+
+	*/
+	template<typename First, typename Second, typename T = std::pair<typename RangeElement<First>::Type, typename RangeElement<Second>::Type>>
+	class ZipStream;
+
+	/*
+		Stream of the elements of several streams, one stream after the other
+
+		The streams are pushed in turn through their own stages, so each of them
+		keeps its fast paths
+
+	*/
+	template<typename T, typename... Streams>
+	class ConcatStream;
+
+	/*
+		Stream merging several sorted streams into a single sorted stream
+
+		The heads of the streams play a loser tree, so each element costs about
+		log2(N) comparisons for N streams. Equal elements come out in the order
+		of their streams
+
+		==> Less: strict weak ordering the streams are sorted by, like std::less<T>
+
+	*/
+	template<typename T, typename Less, typename... Streams>
+	class MergeSortedStream;
+
+	/*
+		Type-erased stream
+
+		Wraps any stream of elements of type T behind a runtime interface, so
+		pipelines of different types can be stored or passed around as the same type.
+		Every element pulled from it costs virtual calls, so prefer the concrete
+		stream types unless runtime polymorphism is actually needed
+
+		==> Copyable: whether the stream is copyable, in which case it only wraps copyable
+			pipelines. Move-only AnyStreams also wrap pipelines holding a std::unique_ptr, for example
+
+	*/
+	template<typename T, bool Copyable = true>
+	class AnyStream;
+
+#if defined(STREAM_HAS_COROUTINES)
+	/*
+		Stream over the elements of an asynchronous generator
+
+		Its elements are pulled with co_await, so it is consumed by the asynchronous
+		terminal operations forEachAsync() and collectAsync() only. It is never parallel
+
+		==> Generator: an AsyncGenerator<T>, or any type with a value_type and a next() whose co_await gives an Optional<value_type>
+
+	*/
+	template<typename T, typename Generator>
+	class AsyncSourceStream;
+#endif
+
+
+	template<typename Stream>
+	struct IsSourceStream : std::false_type
+	{
+
+	};
+
+	template<typename T, typename Iterator>
+	struct IsSourceStream<SourceStream<T, Iterator>> : std::true_type
+	{
+
+	};
+
+	/*
+		Kinds of stages fused with an adjacent stage of the same kind when the pipeline is built
+	*/
+	template<typename Stream>
+	struct IsFilterStream : std::false_type
+	{
+
+	};
+
+	template<typename T, typename PreviousStream, typename Condition>
+	struct IsFilterStream<FilterStream<T, PreviousStream, Condition>> : std::true_type
+	{
+
+	};
+
+	template<typename Stream>
+	struct IsMapStream : std::false_type
+	{
+
+	};
+
+	template<typename T, typename R, typename PreviousStream, typename MapFunction>
+	struct IsMapStream<MapStream<T, R, PreviousStream, MapFunction>> : std::true_type
+	{
+
+	};
+
+	template<typename Stream>
+	struct IsLimitStream : std::false_type
+	{
+		static constexpr size_t Size = DynamicSize;
+	};
+
+	template<typename T, size_t MaxSize, typename PreviousStream>
+	struct IsLimitStream<LimitStream<T, MaxSize, PreviousStream>> : std::true_type
+	{
+		static constexpr size_t Size = MaxSize;
+	};
+
+	template<typename Stream>
+	struct IsSkipStream : std::false_type
+	{
+		static constexpr size_t Size = DynamicSize;
+	};
+
+	template<typename T, size_t N, typename PreviousStream>
+	struct IsSkipStream<SkipStream<T, N, PreviousStream>> : std::true_type
+	{
+		static constexpr size_t Size = N;
+	};
+
+
+#define _STREAM_FRIEND_TYPES_ \
+	template<class _T, class _Self> friend class Stream;\
+	template<class _T, bool _Copyable> friend class AnyStream;\
+	template<class _T, class _Iterator> friend class SourceStream;\
+	template<class _T, class _PreviousStream, class _Condition> friend class FilterStream;\
+	template<class _T, size_t _MaxSize, class _PreviousStream> friend class LimitStream;\
+	template<class _T, size_t _N, class _PreviousStream> friend class SkipStream;\
+	template<class _T, size_t _N, class _PreviousStream> friend class ChunkStream;\
+	template<class _T, size_t _N, class _PreviousStream> friend class SlidingStream;\
+	template<class _T, class _PreviousStream, class _Set> friend class DistinctStream;\
+	template<class _T, class _PreviousStream, class _Less> friend class SortedStream;\
+	template<class _T, class _R, class _PreviousStream, class _MapFunction> friend class MapStream;\
+	template<class _T, class _R, class _PreviousStream, class _FlatMapFunction> friend class FlatMapStream;\
+	template<class _First, class _Second, class _T> friend class ZipStream;\
+	template<class _T, class... _Streams> friend class ConcatStream;\
+	template<class _T, class _Less, class... _Streams> friend class MergeSortedStream;\
+
+// ===============================================================================================================================
+
+	// ===> UTILITY FUNCTIONS <===
+
+
+	/*
+		Creates an empty stream
+	*/
+	template<typename T>
+	SourceStream<T, T*> empty()
+	{
+		return SourceStream<T, T*>(Spliterator<T, T*>(nullptr, nullptr, ORDERED | DISTINCT | SORTED));
+	}
+
+	/*
+		Creates a stream from the given array and the given size
+
+		==> T* values: the data container
+		==> size_t size: the size of the data collection 
+
+	*/
+	template<typename T>
+	STREAM_CONSTEXPR SourceStream<T, T*> of(T* values, size_t size)
+	{
+		return SourceStream<T, T*>(values, values + size);
+	}
+
+	/*
+		Creates a stream from the given container.
+		
+		You may also specify its type and iterator. Const containers are traversed through their const_iterator
+
+		==> Container& container: the data container
+
+	*/
+	template<
+		class Container,
+		class T = typename Container::value_type,
+		class Iterator = decltype(std::begin(std::declval<Container&>()))>
+	STREAM_CONSTEXPR SourceStream<T, Iterator> of(Container& container)
+	{
+		return SourceStream<T, Iterator>(Spliterator<T, Iterator>(std::begin(container), std::end(container),
+			containerCharacteristics<Container>(), containerSize(container)));
+	}
+
+	/*
+		Creates a stream containing the elements within the given iterators
+
+		==> Iterator begin: the start iterator
+		==> Iterator end: the end iterator
+
+	*/
+	template<class T, class Iterator>
+	STREAM_CONSTEXPR SourceStream<T, Iterator> of(Iterator begin, Iterator end)
+	{
+		return SourceStream<T, Iterator>(std::move(begin), std::move(end));
+	}
+
+	/*
+		Creates a stream that moves the elements out of the given container.
+
+		Elements are moved into the pipeline instead of being copied, so move-only
+		types such as std::unique_ptr can be streamed. The container is left
+		with moved-from elements
+
+		==> Container& container: the data container
+
+	*/
+	template<
+		class Container,
+		class T = typename Container::value_type,
+		class Iterator = std::move_iterator<typename Container::iterator>>
+	SourceStream<T, Iterator> ofMove(Container& container)
+	{
+		return SourceStream<T, Iterator>(Spliterator<T, Iterator>(std::make_move_iterator(std::begin(container)), std::make_move_iterator(std::end(container)),
+			containerCharacteristics<Container>(), containerSize(container)));
+	}
+
+	/*
+		Creates an empty pipeline of elements of type T, to build once and run over many inputs
+		with run(container). Building and running a stream for each input costs the construction
+		of every stage, and of their storage, each time
+
+	*/
+	template<typename T>
+	SourceStream<T, const T*> pipeline()
+	{
+		return SourceStream<T, const T*>(nullptr, nullptr);
+	}
+
+	/*
+		Creates a stream of the values returned by successive calls to supplier, computed on demand.
+		The stream is infinite, so it must be truncated by limit() or a short-circuiting terminal operation
+
+		==> Supplier supplier: the function returning each element
+
+	*/
+	template<typename Supplier, typename T = std::decay_t<std::invoke_result_t<Supplier&>>>
+	SourceStream<T, GenerateIterator<T, Supplier>> generate(Supplier supplier)
+	{
+		using Iterator = GenerateIterator<T, Supplier>;
+		return SourceStream<T, Iterator>(Iterator(supplier, false), Iterator(supplier, true));
+	}
+
+	/*
+		Creates the stream seed, function(seed), function(function(seed)), ... computed on demand.
+		The stream is infinite, so it must be truncated by limit() or a short-circuiting terminal operation
+
+		==> T seed: the first element
+		==> Function function: the function computing each element from the previous one
+
+	*/
+	template<typename T, typename Function>
+	auto iterate(T seed, Function function)
+	{
+		return generate([value = std::move(seed), function = std::move(function), first = true]() mutable
+		{
+			if(!first)
+			{
+				value = function(std::as_const(value));
+			}
+
+			first = false;
+			return value;
+		});
+	}
+
+	/*
+		Creates the stream begin, begin + step, begin + 2 * step, ... of the values before end.
+		The stream is SIZED and splittable, and holds no values in memory. Floating-point ranges
+		too long to count, e.g. with an infinite end, are infinite like iterate().
+		Throws std::invalid_argument if step is zero
+
+		==> T begin: the first element
+		==> T end: the bound excluded from the stream
+		==> T step: the difference between two elements, which may be negative
+
+	*/
+	template<typename T>
+	STREAM_CONSTEXPR SourceStream<T, RangeIterator<T>> range(T begin, T end, T step = T(1))
+	{
+		static_assert(std::is_arithmetic_v<T>, "range() needs an arithmetic type");
+
+		if(step == T(0))
+		{
+			throw std::invalid_argument("The step of a range must not be zero");
+		}
+
+		// Rounding may give consecutive floating-point values the same value, which are still in order
+		const unsigned distinct = std::is_integral_v<T> ? DISTINCT : 0u;
+		const unsigned characteristics = step > T(0) ? ORDERED | distinct | SORTED : ORDERED | distinct;
+
+		return SourceStream<T, RangeIterator<T>>(Spliterator<T, RangeIterator<T>>(RangeIterator<T>(begin, step, 0),
+			RangeIterator<T>(begin, step, rangeSize(begin, end, step)), characteristics));
+	}
+
+	/*
+		Creates the stream of the pairs of elements of first and second, taken in lockstep,
+		e.g. zip(of(keys), of(values)). It ends with the shorter stream, and is SIZED if both are
+
+		==> First first: the stream of the first elements of the pairs
+		==> Second second: the stream of the second elements of the pairs
+
+	*/
+	template<typename First, typename Second>
+	ZipStream<First, Second> zip(First first, Second second)
+	{
+		static_assert(IsStream<First>::value && IsStream<Second>::value, "zip() takes streams, e.g. zip(of(keys), of(values))");
+		return ZipStream<First, Second>(std::move(first), std::move(second));
+	}
+
+	/*
+		Creates the stream of the elements of every stream, one stream after the other.
+		The elements are converted to the common type of the elements of the streams
+
+		==> Streams... streams: the streams to concatenate, in order
+
+	*/
+	template<typename... Streams, typename T = std::common_type_t<typename RangeElement<Streams>::Type...>>
+	ConcatStream<T, Streams...> concat(Streams... streams)
+	{
+		static_assert(sizeof...(Streams) > 0 && (IsStream<Streams>::value && ...), "concat() takes one or more streams");
+		return ConcatStream<T, Streams...>(std::move(streams)...);
+	}
+
+	/*
+		Creates the stream of the elements of every stream in sorted order. Each stream must already be
+		sorted by comparator, which returns a negative value if its first argument is less than the second,
+		like the comparators of sorted(). The result is not SORTED, as it is not in natural order
+
+		==> Compare comparator: the order of the streams
+		==> Streams... streams: the sorted streams to merge
+
+	*/
+	template<typename Compare, typename... Streams, typename = std::enable_if_t<!IsStream<Compare>::value>,
+		typename T = std::common_type_t<typename RangeElement<Streams>::Type...>>
+	MergeSortedStream<T, ComparatorLess<T, Compare>, Streams...> mergeSorted(Compare comparator, Streams... streams)
+	{
+		static_assert(sizeof...(Streams) > 0 && (IsStream<Streams>::value && ...), "mergeSorted() takes one or more streams");
+		return MergeSortedStream<T, ComparatorLess<T, Compare>, Streams...>(ComparatorLess<T, Compare>{std::move(comparator)}, std::move(streams)...);
+	}
+
+	/*
+		Creates the stream of the elements of every stream in natural order. Each stream must already be
+		sorted in natural order. The result is SORTED, so e.g. distinct() only compares adjacent elements
+
+		==> Streams... streams: the sorted streams to merge
+
+	*/
+	template<typename First, typename... Streams, typename = std::enable_if_t<IsStream<First>::value>,
+		typename T = std::common_type_t<typename RangeElement<First>::Type, typename RangeElement<Streams>::Type...>>
+	MergeSortedStream<T, std::less<T>, First, Streams...> mergeSorted(First first, Streams... streams)
+	{
+		static_assert((IsStream<Streams>::value && ...), "mergeSorted() takes a comparator followed by streams, or only streams");
+		return MergeSortedStream<T, std::less<T>, First, Streams...>(std::less<T>(), std::move(first), std::move(streams)...);
+	}
+
+#if defined(STREAM_HAS_COROUTINES)
+	/*
+		Creates a stream over the elements of generator, as they arrive
+
+		==> Generator generator: the asynchronous generator, e.g. an AsyncGenerator<T>
+
+	*/
+	template<typename Generator, typename T = typename Generator::value_type>
+	AsyncSourceStream<T, Generator> fromAsync(Generator generator)
+	{
+		return AsyncSourceStream<T, Generator>(std::move(generator));
+	}
+#endif
+
+	/*
+		Creates a stream over the records of file in place, without copying them.
+		A trailing partial record is ignored
+
+		==> T: a trivially copyable record type, stored in the file as in memory
+		==> std::shared_ptr<const MappedFile> file: the file, kept alive by the stream
+
+	*/
+	template<typename T>
+	SourceStream<T, const T*> mmap(std::shared_ptr<const MappedFile> file)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Records of a mapped file must be trivially copyable");
+
+		const T* values = reinterpret_cast<const T*>(file->data());
+		const size_t size = file->size() / sizeof(T);
+
+		return SourceStream<T, const T*>(Spliterator<T, const T*>(values, values + size), std::move(file));
+	}
+
+	/*
+		Creates a stream over the records of the file at path, memory-mapped where possible.
+		Throws std::runtime_error if the file cannot be read
+
+		==> const std::string& path: the path of the file
+
+	*/
+	template<typename T>
+	SourceStream<T, const T*> mmap(const std::string& path)
+	{
+		return mmap<T>(std::make_shared<const MappedFile>(path));
+	}
+
+	/*
+		Creates a stream over the lines of file, without their '\n' terminator.
+		The views point into the file, so they are only valid while it is alive: keep
+		the shared_ptr, or copy the lines into strings, to use them after the stream
+
+		==> std::shared_ptr<const MappedFile> file: the file, kept alive by the stream
+
+	*/
+	inline SourceStream<std::string_view, LineIterator> lines(std::shared_ptr<const MappedFile> file);
+
+	/*
+		Creates a stream over the lines of the file at path, memory-mapped where possible.
+		Throws std::runtime_error if the file cannot be read
+
+		==> const std::string& path: the path of the file
+
+	*/
+	inline SourceStream<std::string_view, LineIterator> lines(const std::string& path);
+
+	
+
+
+// ===============================================================================================================================
+
+
+	// ===> IMPLEMENTATIONS <===
+
+	template<typename T, typename Self>
+	class Stream
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		// ===> Intermediate operations <===
+
+		/*
+			Intermediate operations on an rvalue stream move it into the new stage,
+			so building a pipeline costs one move per stage. On an lvalue stream, the
+			new stage gets a copy of it and the original stream is left untouched
+		*/
+
+		/*
+			Discards repeated elements, keeping them in a FlatHashSet sized
+			to hold expectedSize unique elements without growing
+		*/
+		DistinctStream<T, Self> distinct(size_t expectedSize = 0) &&
+		{
+			return DistinctStream<T, Self>(std::move(self()), FlatHashSet<T>(expectedSize));
+		}
+
+		DistinctStream<T, Self> distinct(size_t expectedSize = 0) &
+		{
+			return Self(self()).distinct(expectedSize);
+		}
+
+		/*
+			Discards repeated elements, keeping them in set. This allows custom hash and
+			equality functions, e.g. distinctWith(FlatHashSet<T, Hash, Equal>(expectedSize)),
+			or any set with an insert(element).second like std::unordered_set
+		*/
+		template<typename Set>
+		DistinctStream<T, Self, Set> distinctWith(Set set) &&
+		{
+			return DistinctStream<T, Self, Set>(std::move(self()), std::move(set));
+		}
+
+		template<typename Set>
+		DistinctStream<T, Self, Set> distinctWith(Set set) &
+		{
+			return Self(self()).distinctWith(std::move(set));
+		}
+
+		/*
+			Discards repeated elements using a BloomFilter of the given bits, so its memory stays fixed
+			however many unique elements go through. Repeated elements are always discarded, but a
+			unique element is also discarded with the false positive rate of the filter, see BloomFilter
+		*/
+		template<typename Hash = std::hash<T>>
+		DistinctStream<T, Self, BloomFilter<T, Hash>> distinctApprox(size_t bits, unsigned hashes = 7, Hash hash = Hash()) &&
+		{
+			return std::move(self()).distinctWith(BloomFilter<T, Hash>(bits, hashes, std::move(hash)));
+		}
+
+		template<typename Hash = std::hash<T>>
+		DistinctStream<T, Self, BloomFilter<T, Hash>> distinctApprox(size_t bits, unsigned hashes = 7, Hash hash = Hash()) &
+		{
+			return Self(self()).distinctApprox(bits, hashes, std::move(hash));
+		}
+
+		/*
+			Stages are fused with the stage before them when the pipeline is built, so the work evaluated
+			for each element matches a hand-fused loop:
+
+			==> filter(a).filter(b) becomes filter(a && b)
+			==> map(f).map(g) becomes map(g(f(x)))
+			==> skip(n).skip(m) becomes skip(n + m), and limit(n).limit(m) becomes limit(min(n, m))
+			==> map(f).limit(n) becomes limit(n).map(f), so f is only called on the elements kept
+
+			The fused pipelines have other types than the unfused ones, so prefer auto to spelling them out
+		*/
+
+		template<typename Condition>
+		STREAM_CONSTEXPR auto filter(Condition condition) &&
+		{
+			if constexpr(IsFilterStream<Self>::value)
+			{
+				using Fused = Conjunction<std::decay_t<decltype(self().m_Condition)>, Condition>;
+				return std::move(self().m_Previous).filter(Fused{std::move(self().m_Condition), std::move(condition)});
+			}
+			else
+			{
+				return FilterStream<T, Self, Condition>(std::move(self()), std::move(condition));
+			}
+		}
+
+		template<typename Condition>
+		STREAM_CONSTEXPR auto filter(Condition condition) &
+		{
+			return Self(self()).filter(std::move(condition));
+		}
+
+		template<size_t MaxSize>
+		STREAM_CONSTEXPR auto limit() &&
+		{
+			if constexpr(IsMapStream<Self>::value)
+			{
+				return std::move(self().m_Previous).template limit<MaxSize>().template map<T>(std::move(self().m_MapFunction));
+			}
+			else if constexpr(IsLimitStream<Self>::value && IsLimitStream<Self>::Size != DynamicSize)
+			{
+				return std::move(self().m_Previous).template limit<std::min(IsLimitStream<Self>::Size, MaxSize)>();
+			}
+			else if constexpr(IsLimitStream<Self>::value)
+			{
+				return std::move(self()).limit(MaxSize);
+			}
+			else
+			{
+				return LimitStream<T, MaxSize, Self>(std::move(self()));
+			}
+		}
+
+		template<size_t MaxSize>
+		STREAM_CONSTEXPR auto limit() &
+		{
+			return Self(self()).template limit<MaxSize>();
+		}
+
+		/*
+			Limits the stream to maxSize elements given at runtime, so every
+			size shares the same pipeline type
+		*/
+		STREAM_CONSTEXPR auto limit(size_t maxSize) &&
+		{
+			if constexpr(IsMapStream<Self>::value)
+			{
+				return std::move(self().m_Previous).limit(maxSize).template map<T>(std::move(self().m_MapFunction));
+			}
+			else if constexpr(IsLimitStream<Self>::value)
+			{
+				return std::move(self().m_Previous).limit(std::min(self().maxSize(), maxSize));
+			}
+			else
+			{
+				return LimitStream<T, DynamicSize, Self>(std::move(self()), maxSize);
+			}
+		}
+
+		STREAM_CONSTEXPR auto limit(size_t maxSize) &
+		{
+			return Self(self()).limit(maxSize);
+		}
+
+		/*
+			The result type R may be omitted, in which case it is deduced from the map function
+		*/
+		template<typename R = void, typename MapFunction, typename Result = MapResult<R, T, MapFunction>>
+		STREAM_CONSTEXPR auto map(MapFunction mapFunction) &&
+		{
+			if constexpr(IsMapStream<Self>::value)
+			{
+				using Fused = Composition<T, std::decay_t<decltype(self().m_MapFunction)>, MapFunction>;
+				return std::move(self().m_Previous).template map<Result>(Fused{std::move(self().m_MapFunction), std::move(mapFunction)});
+			}
+			else
+			{
+				return MapStream<T, Result, Self, MapFunction>(std::move(self()), std::move(mapFunction));
+			}
+		}
+
+		template<typename R = void, typename MapFunction, typename Result = MapResult<R, T, MapFunction>>
+		STREAM_CONSTEXPR auto map(MapFunction mapFunction) &
+		{
+			return Self(self()).template map<Result>(std::move(mapFunction));
+		}
+
+		/*
+			Replaces each element with the elements of the stream or range returned by
+			flatMapFunction, e.g. the tokens of a line. The result type R may be omitted,
+			in which case it is deduced from the stream or range.
+			Streams returned by flatMapFunction are built for each element, so the storage of their stages,
+			like the set of an inner distinct(), is allocated again for each element: see flatMap(inner, rangeFunction)
+		*/
+		template<typename R = void, typename FlatMapFunction, typename Result = FlatMapResult<R, T, FlatMapFunction>>
+		FlatMapStream<T, Result, Self, FlatMapFunction> flatMap(FlatMapFunction flatMapFunction) &&
+		{
+			return FlatMapStream<T, Result, Self, FlatMapFunction>(std::move(self()), std::move(flatMapFunction));
+		}
+
+		template<typename R = void, typename FlatMapFunction, typename Result = FlatMapResult<R, T, FlatMapFunction>>
+		FlatMapStream<T, Result, Self, FlatMapFunction> flatMap(FlatMapFunction flatMapFunction) &
+		{
+			return Self(self()).template flatMap<Result>(std::move(flatMapFunction));
+		}
+
+		/*
+			Replaces each element with the elements of inner, a pipeline created by stream::pipeline<U>(), run over
+			the contiguous elements of U returned by rangeFunction, e.g. the tokens of a line:
+
+			auto words = stream::of(lines).flatMap(stream::pipeline<std::string_view>().filter(isWord).distinct(), tokenize);
+
+			The stage keeps inner and runs it again for each element, so its stages keep their storage, like the
+			set of an inner distinct(). rangeFunction may return a reference to a buffer it reuses, so nothing is
+			allocated for each element. The pipeline is shared by the elements, so the stage never runs in parallel
+		*/
+		template<typename Pipeline, typename RangeFunction, typename Inner = InnerPipeline<T, Pipeline, RangeFunction>>
+		FlatMapStream<T, typename RangeElement<Pipeline>::Type, Self, Inner> flatMap(Pipeline inner, RangeFunction rangeFunction) &&
+		{
+			return FlatMapStream<T, typename RangeElement<Pipeline>::Type, Self, Inner>(std::move(self()), Inner{std::move(inner), std::move(rangeFunction), {}});
+		}
+
+		template<typename Pipeline, typename RangeFunction, typename Inner = InnerPipeline<T, Pipeline, RangeFunction>>
+		FlatMapStream<T, typename RangeElement<Pipeline>::Type, Self, Inner> flatMap(Pipeline inner, RangeFunction rangeFunction) &
+		{
+			return Self(self()).flatMap(std::move(inner), std::move(rangeFunction));
+		}
+
+		/*
+			Groups the elements into Spans of N consecutive elements. A chunk is only valid until the next
+			one is passed on, so its elements must be copied to be kept, e.g. with
+			map([](auto chunk) { return std::vector<T>(chunk.begin(), chunk.end()); })
+		*/
+		template<size_t N>
+		ChunkStream<T, N, Self> chunk() &&
+		{
+			static_assert(N > 0 && N != DynamicSize, "The size of a chunk must not be zero");
+			return ChunkStream<T, N, Self>(std::move(self()));
+		}
+
+		template<size_t N>
+		ChunkStream<T, N, Self> chunk() &
+		{
+			return Self(self()).template chunk<N>();
+		}
+
+		/*
+			Groups the elements into chunks of size elements given at runtime.
+			Throws std::invalid_argument if size is zero
+		*/
+		ChunkStream<T, DynamicSize, Self> chunk(size_t size) &&
+		{
+			return ChunkStream<T, DynamicSize, Self>(std::move(self()), size);
+		}
+
+		ChunkStream<T, DynamicSize, Self> chunk(size_t size) &
+		{
+			return Self(self()).chunk(size);
+		}
+
+		/*
+			Passes on the Span of the last N elements for each element from the N-th one on, e.g. for rolling
+			statistics. Like chunks, a window is only valid until the next one is passed on
+		*/
+		template<size_t N>
+		SlidingStream<T, N, Self> sliding() &&
+		{
+			static_assert(N > 0 && N != DynamicSize, "The size of a sliding window must not be zero");
+			return SlidingStream<T, N, Self>(std::move(self()));
+		}
+
+		template<size_t N>
+		SlidingStream<T, N, Self> sliding() &
+		{
+			return Self(self()).template sliding<N>();
+		}
+
+		/*
+			Windows of size elements given at runtime. Throws std::invalid_argument if size is zero
+		*/
+		SlidingStream<T, DynamicSize, Self> sliding(size_t size) &&
+		{
+			return SlidingStream<T, DynamicSize, Self>(std::move(self()), size);
+		}
+
+		SlidingStream<T, DynamicSize, Self> sliding(size_t size) &
+		{
+			return Self(self()).sliding(size);
+		}
+
+		template<size_t N>
+		STREAM_CONSTEXPR auto skip() &&
+		{
+			if constexpr(IsSkipStream<Self>::value && IsSkipStream<Self>::Size != DynamicSize
+				&& N < DynamicSize - IsSkipStream<Self>::Size)
+			{
+				return std::move(self().m_Previous).template skip<IsSkipStream<Self>::Size + N>();
+			}
+			else if constexpr(IsSkipStream<Self>::value)
+			{
+				return std::move(self()).skip(N);
+			}
+			else
+			{
+				return SkipStream<T, N, Self>(std::move(self()));
+			}
+		}
+
+		template<size_t N>
+		STREAM_CONSTEXPR auto skip() &
+		{
+			return Self(self()).template skip<N>();
+		}
+
+		/*
+			Skips count elements given at runtime. On random-access sources, followed
+			only by maps, the elements are skipped in O(1) without being read
+		*/
+		STREAM_CONSTEXPR auto skip(size_t count) &&
+		{
+			if constexpr(IsSkipStream<Self>::value)
+			{
+				// Saturates, as skipping more elements than the stream holds skips them all anyway
+				const size_t skipCount = self().skipCount();
+				return std::move(self().m_Previous).skip(count > DynamicSize - 1 - skipCount ? DynamicSize - 1 : skipCount + count);
+			}
+			else
+			{
+				return SkipStream<T, DynamicSize, Self>(std::move(self()), count);
+			}
+		}
+
+		STREAM_CONSTEXPR auto skip(size_t count) &
+		{
+			return Self(self()).skip(count);
+		}
+
+		/*
+			Sorts the elements in natural order. Parallel pipelines sort large inputs on their executor
+		*/
+		SortedStream<T, Self> sorted() &&
+		{
+			return SortedStream<T, Self>(std::move(self()), std::less<T>());
+		}
+
+		SortedStream<T, Self> sorted() &
+		{
+			return Self(self()).sorted();
+		}
+
+		/*
+			Sorts the elements with comparator, which returns a negative value if its first argument
+			is less than the second, like the comparators of min() and max()
+		*/
+		template<typename Compare>
+		SortedStream<T, Self, ComparatorLess<T, Compare>> sorted(Compare comparator) &&
+		{
+			return SortedStream<T, Self, ComparatorLess<T, Compare>>(std::move(self()), ComparatorLess<T, Compare>{std::move(comparator)});
+		}
+
+		template<typename Compare>
+		SortedStream<T, Self, ComparatorLess<T, Compare>> sorted(Compare comparator) &
+		{
+			return Self(self()).sorted(std::move(comparator));
+		}
+
+		// ===> Execution modes <===
+
+		/*
+			Makes the terminal operation run in parallel on the given executor
+
+			The source is split into chunks, each of them pushed through the pipeline
+			by a different task, and the partial results are combined in encounter order.
+			Only pipelines made of a random-access source followed by stateless stages
+			(filter, map) are split. Pipelines with stateful stages (limit, skip, distinct, sorted)
+			keep running sequentially, so their results respect the encounter order.
+			The operations passed to the pipeline may be called concurrently
+		*/
+		Self parallel(Executor& executor = defaultExecutor()) &&
+		{
+			self().source().m_Options.executor = &executor;
+			return std::move(self());
+		}
+
+		Self parallel(Executor& executor = defaultExecutor()) &
+		{
+			return Self(self()).parallel(executor);
+		}
+
+		Self sequential() &&
+		{
+			self().source().m_Options.executor = nullptr;
+			return std::move(self());
+		}
+
+		Self sequential() &
+		{
+			return Self(self()).sequential();
+		}
+
+		/*
+			Lifts the encounter order requirement. In parallel, findFirst() may then
+			return any element of the stream instead of the first one
+		*/
+		Self unordered() &&
+		{
+			self().source().m_Options.ordered = false;
+			return std::move(self());
+		}
+
+		Self unordered() &
+		{
+			return Self(self()).unordered();
+		}
+
+		/*
+			Makes the source push its elements in blocks of up to blockSize elements, like a columnar engine.
+			Filters then compute a selection vector for each block, and maps apply their function to all the
+			selected elements of a block at once, so the compiler is able to vectorize both loops.
+			Sources over contiguous elements push blocks in place, without copying them.
+			Selection vectors index blocks with 32-bit integers, so larger blocks throw std::invalid_argument
+		*/
+		Self batched(size_t blockSize = DefaultBlockSize) &&
+		{
+			if(blockSize > std::numeric_limits<uint32_t>::max())
+			{
+				throw std::invalid_argument("The size of a block must fit in 32 bits");
+			}
+
+			self().source().m_Options.blockSize = blockSize;
+			return std::move(self());
+		}
+
+		Self batched(size_t blockSize = DefaultBlockSize) &
+		{
+			return Self(self()).batched(blockSize);
+		}
+
+		/*
+			Makes the stages allocate their internal storage (the set of distinct(), the buffers
+			of batched pipelines) from resource, which must outlive the pipeline. Containers using
+			a std::pmr::polymorphic_allocator, like std::pmr::vector, are also created with it by collect().
+			With a std::pmr::monotonic_buffer_resource, a short-lived pipeline does almost no malloc/free.
+			Parallel pipelines allocate from several threads, so they need a synchronized resource
+		*/
+		Self withResource(std::pmr::memory_resource* resource) &&
+		{
+			self().source().m_Options.resource = resource;
+			return std::move(self());
+		}
+
+		Self withResource(std::pmr::memory_resource* resource) &
+		{
+			return Self(self()).withResource(resource);
+		}
+
+		/*
+			Allows floating-point sums, averages, min and max to be evaluated in any order, so
+			they can run in SIMD lanes. Results may then differ in rounding from a sequential loop,
+			and NaN values are not handled consistently
+		*/
+		Self reassociate() &&
+		{
+			self().source().m_Options.reassociate = true;
+			return std::move(self());
+		}
+
+		Self reassociate() &
+		{
+			return Self(self()).reassociate();
+		}
+
+		/*
+			Records the statistics of each stage into stats, which must outlive the pipeline.
+			Only if STREAM_PROFILING is defined: otherwise the pipeline is left untouched
+		*/
+		Self profiled(PipelineStats* stats) &&
+		{
+#if defined(STREAM_PROFILING)
+			self().source().m_Options.stats = stats;
+#else
+			(void)stats;
+#endif
+			return std::move(self());
+		}
+
+		Self profiled(PipelineStats* stats) &
+		{
+			return Self(self()).profiled(stats);
+		}
+
+		// ===> Reusable pipelines <===
+
+		/*
+			Points the source of a pipeline created by stream::pipeline<T>() at the elements of container,
+			which must be stored contiguously, e.g. a std::vector or a std::array. The stages forget the state
+			left by the previous run but keep their storage, e.g. the set of distinct() keeps its capacity,
+			and the execution modes are kept. Returns this pipeline, to run a terminal operation on:
+
+			auto pipeline = stream::pipeline<int>().filter(isValid).map<std::string>(toString);
+			for(const std::vector<int>& batch : batches)
+			{
+				send(pipeline.run(batch).collect<std::vector<std::string>>());
+			}
+
+			The pipeline is not copied, so it must not be run by several threads at once
+		*/
+		template<typename Container>
+		Self& run(const Container& container)
+		{
+			return run(std::data(container), std::size(container), containerCharacteristics<Container>());
+		}
+
+		/*
+			Points the source of a pipeline created by stream::pipeline<T>() at the given array and size
+		*/
+		template<typename E>
+		Self& run(const E* values, size_t size)
+		{
+			return run(values, size, ORDERED);
+		}
+
+		// ===> Terminal operations <===
+
+		template<typename Condition>
+		bool allMatch(Condition condition)
+		{
+			bool failed = false;
+
+			evaluate(failed, [&](bool& failed, auto&& element)
+			{
+				failed = !condition(element);
+				return !failed;
+			},
+			[](bool& failed, bool&& other) { failed = failed || other; }, ShortCircuit::AllChunks);
+
+			return !failed;
+		}
+
+		template<typename Condition>
+		bool anyMatch(Condition condition)
+		{
+			bool found = false;
+
+			evaluate(found, [&](bool& found, auto&& element)
+			{
+				found = condition(element);
+				return !found;
+			},
+			[](bool& found, bool&& other) { found = found || other; }, ShortCircuit::AllChunks);
+
+			return found;
+		}
+
+		/*
+			A std::array is filled in encounter order. The elements it has no room for throw
+			std::length_error, and the slots the stream has no element for are left value-initialized
+		*/
+		template<typename Container>
+		STREAM_CONSTEXPR Container collect()
+		{
+			if constexpr(IsArray<Container>::value)
+			{
+				return collectArray<Container>();
+			}
+			else
+			{
+				Container container = makeContainer<Container>();
+				return std::move(collect(container));
+			}
+		}
+
+		/*
+			If the exact number of elements is known, the container reserves
+			space for them first, provided it has a reserve() method
+		*/
+		template<typename Container>
+		Container& collect(Container& container)
+		{
+			if constexpr(IsReservable<Container>::value)
+			{
+				if((self().characteristics() & SIZED) != 0)
+				{
+					container.reserve(std::size(container) + self().estimateSize());
+				}
+			}
+
+			evaluate(container, [&]() { return makeContainer<Container>(); }, [](Container& container, auto&& element)
+			{
+				container.insert(std::end(container), std::forward<decltype(element)>(element));
+				return true;
+			},
+			[](Container& container, Container&& other)
+			{
+				if constexpr(IsRangeInsertable<Container>::value)
+				{
+					container.insert(std::end(container), std::make_move_iterator(std::begin(other)), std::make_move_iterator(std::end(other)));
+				}
+				else
+				{
+					for(auto& element : other)
+					{
+						container.insert(std::end(container), std::move(element));
+					}
+				}
+			});
+
+			return container;
+		}
+
+		/*
+			Collects the elements with the given collector. Collectors with a
+			combine(Collector&& other) method are also able to collect in parallel
+		*/
+		template<typename Collector, typename Container = typename Collector::ContainerType>
+		Container collect(Collector collector)
+		{
+			auto insert = [](Collector& collector, auto&& element)
+			{
+				collector.insert(std::forward<decltype(element)>(element));
+				return true;
+			};
+
+			if constexpr(collectors::IsCombinable<Collector>::value)
+			{
+				const Collector neutral = collector;
+				evaluate(collector, [&]() { return neutral; }, insert, [](Collector& collector, Collector&& other) { collector.combine(std::move(other)); });
+			}
+			else
+			{
+				evaluate([&](auto&& element) { return insert(collector, std::forward<decltype(element)>(element)); });
+			}
+
+			return *collector;
+		}
+
+		/*
+			Collects the elements with a collector factory from the collectors namespace, e.g. collectors::counting()
+		*/
+		template<typename Factory, typename = std::enable_if_t<collectors::IsFactory<Factory, T>::value>>
+		auto collect(Factory factory)
+		{
+			using Collector = decltype(factory.template bind<T>());
+
+			Collector collector = factory.template bind<T>();
+
+			auto insert = [](Collector& collector, auto&& element)
+			{
+				collector.insert(std::forward<decltype(element)>(element));
+				return true;
+			};
+
+			if constexpr(collectors::IsCombinable<Collector>::value)
+			{
+				evaluate(collector, [&]() { return factory.template bind<T>(); }, insert, [](Collector& collector, Collector&& other) { collector.combine(std::move(other)); });
+			}
+			else
+			{
+				evaluate([&](auto&& element) { return insert(collector, std::forward<decltype(element)>(element)); });
+			}
+
+			return *collector;
+		}
+
+#if defined(STREAM_HAS_COROUTINES)
+		/*
+			Terminal operations of the streams from fromAsync(). The stream is moved into the returned task, which
+			runs when it is awaited. Each element goes through the pipeline before the next one is awaited, so
+			the generator stays suspended, and applies backpressure, until the pipeline has consumed it
+		*/
+		template<typename Action>
+		Task<void> forEachAsync(Action consumer)
+		{
+			return evaluateAsync(std::move(self()), [consumer = std::move(consumer)](auto&& element) mutable
+			{
+				consumer(std::forward<decltype(element)>(element));
+				return true;
+			});
+		}
+
+		template<typename Container>
+		Task<Container> collectAsync()
+		{
+			return collectAsync<Container>(std::move(self()));
+		}
+#endif
+
+		/*
+			SIZED pipelines only count their elements, without traversing them.
+			The operations of their stages are then not called
+		*/
+		STREAM_CONSTEXPR size_t count()
+		{
+			if((self().characteristics() & SIZED) != 0)
+			{
+				const size_t size = self().estimateSize();
+				self().source().exhaust();
+				return size;
+			}
+
+			size_t count = 0;
+
+			if(isConstantEvaluated())
+			{
+				pull([&](auto&&)
+				{
+					++count;
+					return true;
+				});
+
+				return count;
+			}
+
+			evaluate(count, [](size_t& count, auto&&)
+			{
+				++count;
+				return true;
+			},
+			[](size_t& count, size_t&& other) { count += other; });
+
+			return count;
+		}
+
+		/*
+			Estimates the number of distinct elements with a HyperLogLog sketch of 2^precision
+			bytes, instead of keeping every unique element like distinct().count().
+			The standard error is about 1.04 / sqrt(2^precision), see HyperLogLog
+		*/
+		template<typename Hash = std::hash<T>>
+		size_t countDistinctApprox(unsigned precision = 14, Hash hash = Hash())
+		{
+			HyperLogLog sketch(precision);
+
+			evaluate(sketch, [&]() { return HyperLogLog(precision); }, [&](HyperLogLog& sketch, auto&& element)
+			{
+				sketch.add(hash(std::as_const(element)));
+				return true;
+			},
+			[](HyperLogLog& sketch, HyperLogLog&& other) { sketch.merge(other); });
+
+			return sketch.estimate();
+		}
+
+		/*
+			Only the first element is consumed, so sorted().findFirst() only looks for the minimum
+		*/
+		Optional<T> findFirst()
+		{
+			self().limitHint(1);
+
+			Optional<T> result;
+
+			// Unordered parallel streams stop every chunk as soon as any of them finds an element
+			const bool anyElement = !self().source().m_Options.ordered;
+
+			evaluate(result, [&](Optional<T>& result, auto&& element)
+			{
+				result.emplace(std::forward<decltype(element)>(element));
+				return false;
+			},
+			[](Optional<T>& result, Optional<T>&& other)
+			{
+				if(!result.has_value())
+				{
+					result = std::move(other);
+				}
+			},
+			anyElement ? ShortCircuit::AllChunks : ShortCircuit::LaterChunks);
+
+			return result;
+		}
+
+		template<typename Action>
+		void forEach(Action consumer)
+		{
+			Nothing nothing;
+
+			evaluate(nothing, [&](Nothing&, auto&& element)
+			{
+				consumer(std::forward<decltype(element)>(element));
+				return true;
+			},
+			[](Nothing&, Nothing&&) {});
+		}
+
+		STREAM_CONSTEXPR Optional<T> max()
+		{
+			if constexpr(IsContiguousArithmetic)
+			{
+				if(!isConstantEvaluated())
+				{
+					return extremeContiguous<false>();
+				}
+			}
+
+			return maxMinInternal([&](const T& next, const T& old) -> bool {return next > old;});
+		}
+
+		template<typename Compare>
+		STREAM_CONSTEXPR Optional<T> max(Compare comparator)
+		{
+			return maxMinInternal([&](const T& next, const T& old) -> bool {return comparator(next, old) > 0;});
+		}
+
+		STREAM_CONSTEXPR Optional<T> min()
+		{
+			if constexpr(IsContiguousArithmetic)
+			{
+				if(!isConstantEvaluated())
+				{
+					return extremeContiguous<true>();
+				}
+			}
+
+			return maxMinInternal([&](const T& next, const T& old) -> bool {return next < old;});
+		}
+
+		template<typename Compare>
+		STREAM_CONSTEXPR Optional<T> min(Compare comparator)
+		{
+			return maxMinInternal([&](const T& next, const T& old) -> bool {return comparator(next, old) < 0;});
+		}
+
+		template<typename Condition>
+		bool noneMatch(Condition condition)
+		{
+			return !anyMatch(std::move(condition));
+		}
+
+		template<typename Accumulate>
+		STREAM_CONSTEXPR Optional<T> reduce(Accumulate accumulator)
+		{
+			if constexpr(IsContiguousArithmetic && kernels::isPlus<Accumulate, T>())
+			{
+				if(!isConstantEvaluated())
+				{
+					if(!self().hasRemaining())
+					{
+						return {};
+					}
+
+					const T first = self().next();
+					return sumContiguous<T>(first);
+				}
+			}
+
+			return reduceInternal({}, accumulator);
+		}
+
+		template<typename Accumulate>
+		STREAM_CONSTEXPR Optional<T> reduce(const T& identity, Accumulate accumulator)
+		{
+			if constexpr(IsContiguousArithmetic && kernels::isPlus<Accumulate, T>())
+			{
+				if(!isConstantEvaluated())
+				{
+					return sumContiguous<T>(identity);
+				}
+			}
+
+			return reduceInternal(identity, accumulator);
+		}
+
+		template<typename R = T>
+		R average(R identity = R())
+		{
+			if constexpr(IsContiguousArithmetic && std::is_arithmetic_v<R>)
+			{
+				const size_t count = self().estimateSize();
+				const R sum = sumContiguous<R>(identity);
+				return count == 0 ? identity : sum / count;
+			}
+
+			// Note that T must override operators + and /
+			std::pair<R, size_t> result(identity, 0);
+
+			evaluate(result, []() { return std::pair<R, size_t>(R(), 0); }, [](std::pair<R, size_t>& result, auto&& element)
+			{
+				result.first += (R) element;
+				++result.second;
+				return true;
+			},
+			[](std::pair<R, size_t>& result, std::pair<R, size_t>&& other)
+			{
+				result.first += other.first;
+				result.second += other.second;
+			});
+
+			return result.second == 0 ? identity : result.first / result.second;
+		}
+
+		/*
+			Count, sum, minimum, maximum, mean and variance of arithmetic elements in a single pass, instead
+			of one pass for each of count(), min(), max() and average(). Unlike average(), the sum cannot
+			overflow or lose precision with the number of elements, see SummaryStatistics.
+			Contiguous sources are summarized block by block with the SIMD kernels
+		*/
+		SummaryStatistics<T> summaryStatistics()
+		{
+			SummaryStatistics<T> result;
+
+			if constexpr(IsContiguousArithmetic)
+			{
+				const bool reassociate = self().source().m_Options.reassociate;
+
+				return evaluateContiguous(result, result, [&](SummaryStatistics<T> initial, const T* values, size_t size)
+				{
+					initial.addAll(values, size, reassociate);
+					return initial;
+				},
+				[](SummaryStatistics<T>& result, const SummaryStatistics<T>& partial) { result.merge(partial); });
+			}
+			else
+			{
+				evaluate(result, [](SummaryStatistics<T>& result, auto&& element)
+				{
+					result.add(element);
+					return true;
+				},
+				[](SummaryStatistics<T>& result, SummaryStatistics<T>&& other) { result.merge(other); });
+
+				return result;
+			}
+		}
+
+		/*
+			Estimates the quantiles of arithmetic elements with a t-digest of about compression centroids,
+			instead of sorting every element, e.g. quantilesApprox().quantile(0.99). See TDigest
+		*/
+		TDigest quantilesApprox(double compression = 100)
+		{
+			TDigest digest(compression);
+
+			evaluate(digest, [&]() { return TDigest(compression); }, [](TDigest& digest, auto&& element)
+			{
+				digest.add(static_cast<double>(element));
+				return true;
+			},
+			[](TDigest& digest, TDigest&& other) { digest.merge(other); });
+
+			return digest;
+		}
+
+		/*
+			Pushes every element into aggregator as they come, until the stream ends or aggregator.stop()
+			is called. Unbounded streams never end, so this is run on its own thread while the others
+			read aggregator.snapshot(). The elements are pushed one by one, even in parallel pipelines
+		*/
+		template<typename E, typename Factory>
+		void aggregate(Aggregator<E, Factory>& aggregator)
+		{
+			evaluate([&](auto&& element)
+			{
+				aggregator.insert(std::forward<decltype(element)>(element));
+				return !aggregator.isStopped();
+			});
+		}
+
+	protected:
+
+		/*
+			Stages are dispatched statically through Self. Subclasses must provide
+
+			==> bool hasRemaining(): whether there are more elements to pull
+			==> T next(): pulls the next element. Only called after hasRemaining() returned true
+
+			Intermediate stages must also take part in the push protocol, used by the terminal operations.
+			Elements are pushed from the source through a chain of sinks, one per stage, ending in the terminal operation:
+
+			==> auto& source(): the source stream of the pipeline
+			==> auto sinkChain(Sink sink): wraps sink into this stage's sink, then passes it to the previous stream
+			==> unsigned characteristics(): the Characteristics of the elements coming out of this stage
+			==> size_t estimateSize(): the number of elements coming out of this stage. It is exact
+				if the stage is SIZED, and an upper bound or UnknownSize otherwise
+
+			A sink provides:
+
+			==> bool accept(E&& element): consumes an element. Returns false if no more elements are wanted
+			==> void end(): called once no more elements will be pushed
+			==> bool acceptBlock(const Block<E, Movable>& block): optional, consumes a whole block in batched
+				pipelines. Sinks without it receive the elements of the block one by one
+
+			Sources drive the loop through pushRemaining(Sink& sink). By default they
+			are built on the pull protocol, so only sources need to implement it for speed
+		*/
+		STREAM_CONSTEXPR Self& self()
+		{
+			return static_cast<Self&>(*this);
+		}
+
+		STREAM_CONSTEXPR Self& source()
+		{
+			return self();
+		}
+
+		/*
+			Tells the stream that at most count of its elements will be consumed.
+			Stages mapping each element to exactly one element pass it upstream
+		*/
+		STREAM_CONSTEXPR void limitHint(size_t)
+		{
+
+		}
+
+		/*
+			Forgets the state left by a run, e.g. the elements seen by distinct(), keeping the storage
+			of the stage. Stages with state reset it, then the stages before them
+		*/
+		STREAM_CONSTEXPR void reset()
+		{
+
+		}
+
+		/*
+			Drops up to count elements without evaluating the pipeline for them, if the stream is
+			able to. Returns the number of elements dropped. Only sources and the stages mapping
+			each element to exactly one element are able to: the others drop nothing
+		*/
+		STREAM_CONSTEXPR size_t skipAhead(size_t)
+		{
+			return 0;
+		}
+
+		/*
+			Memory resource the stages allocate their internal storage from
+		*/
+		std::pmr::memory_resource* memoryResource()
+		{
+			std::pmr::memory_resource* resource = self().source().m_Options.resource;
+			return resource != nullptr ? resource : std::pmr::get_default_resource();
+		}
+
+		template<typename Sink>
+		Sink sinkChain(Sink sink)
+		{
+			return sink;
+		}
+
+		/*
+			Wraps the sink of this stage, so profiled pipelines record its statistics under name.
+			Without STREAM_PROFILING, the sink itself is returned
+		*/
+		template<typename Sink>
+		auto profileStage(const char* name, Sink sink)
+		{
+#if defined(STREAM_PROFILING)
+			return ProfiledSink<Self, Sink>{&self(), std::move(sink), profileRecord(name)};
+#else
+			(void)name;
+			return sink;
+#endif
+		}
+
+		template<typename Sink>
+		auto profileTerminal(Sink sink)
+		{
+#if defined(STREAM_PROFILING)
+			return ProfiledSink<Nothing, Sink>{nullptr, std::move(sink), profileRecord("terminal")};
+#else
+			return sink;
+#endif
+		}
+
+		template<typename Sink>
+		void pushRemaining(Sink& sink)
+		{
+			while(self().hasRemaining())
+			{
+				if(!sink.accept(self().next()))
+				{
+					return;
+				}
+			}
+		}
+
+		/*
+			Pushes every remaining element through the stages of this stream into sink, the sink of
+			another pipeline, which is not ended. Returns false if sink wants no more elements,
+			but not if a stage of this stream stopped it, e.g. a limit()
+		*/
+		template<typename Sink>
+		bool pushInto(Sink& sink)
+		{
+			bool stopped = false;
+			auto chain = self().sinkChain(ForwardingSink<Sink>{&sink, &stopped});
+			if(self().estimateSize() != 0)
+			{
+				self().source().pushRemaining(chain);
+			}
+			chain.end();
+			return !stopped;
+		}
+
+		/*
+			Pulls every remaining element into accept(element), until it returns false. Terminal
+			operations evaluated at compile time use it instead of evaluate(), whose sinks can't be
+		*/
+		template<typename Accept>
+		STREAM_CONSTEXPR void pull(Accept accept)
+		{
+			while(self().hasRemaining())
+			{
+				if(!accept(self().next()))
+				{
+					return;
+				}
+			}
+		}
+
+		/*
+			Pushes every remaining element through the pipeline into action,
+			until action returns false. Pipelines known to be empty, e.g. after
+			limit(0), push nothing, so their stages are not evaluated at all
+		*/
+		template<typename Action>
+		void evaluate(Action action)
+		{
+			auto sink = self().sinkChain(profileTerminal(TerminalSink<Action>{std::move(action)}));
+			if(self().estimateSize() != 0)
+			{
+				self().source().pushRemaining(sink);
+			}
+			sink.end();
+		}
+
+		/*
+			Which chunks of a parallel pipeline stop once the terminal operation stops one of them,
+			by returning false from accept(). Chunks not started yet are skipped, and running ones
+			stop before their next element enters the pipeline
+
+			==> LaterChunks: the chunks after it in encounter order, whose elements are no longer needed, e.g. for findFirst()
+			==> AllChunks: every chunk, when any element gives the result, e.g. for anyMatch()
+		*/
+		enum class ShortCircuit
+		{
+			LaterChunks,
+			AllChunks
+		};
+
+		/*
+			Pushes every remaining element into result with accept(result, element), until it returns false.
+
+			If the pipeline runs in parallel, each chunk of the source after the first one is pushed into
+			its own partial result created by makeNeutral() instead, and the partial results are then merged
+			into result in encounter order with combine(result, std::move(partial)). When accept() returns
+			false, the chunks selected by shortCircuit stop too
+		*/
+		template<typename Partial, typename MakeNeutral, typename Accept, typename Combine>
+		void evaluate(Partial& result, MakeNeutral makeNeutral, Accept accept, Combine combine, ShortCircuit shortCircuit = ShortCircuit::LaterChunks)
+		{
+			using SourceType = std::decay_t<decltype(self().source())>;
+
+			if constexpr(Self::IsStateless && SourceType::IsSplittable)
+			{
+				SourceType& source = self().source();
+				Executor* executor = source.m_Options.executor;
+
+				if(executor != nullptr)
+				{
+					auto chunks = source.split(executor->concurrency() * ChunksPerThread, MinChunkSize);
+
+					if(chunks.size() > 1)
+					{
+						evaluateParallel(result, makeNeutral, accept, combine, shortCircuit, *executor, chunks);
+						return;
+					}
+				}
+			}
+
+			evaluate([&](auto&& element) { return accept(result, std::forward<decltype(element)>(element)); });
+		}
+
+		template<typename Partial, typename Accept, typename Combine>
+		void evaluate(Partial& result, Accept accept, Combine combine, ShortCircuit shortCircuit = ShortCircuit::LaterChunks)
+		{
+			evaluate(result, []() { return Partial(); }, std::move(accept), std::move(combine), shortCircuit);
+		}
+
+	private:
+
+		// Parallel streams split their source into up to ChunksPerThread chunks per thread of
+		// the executor, so busy threads can be compensated, but never into chunks smaller than MinChunkSize
+		static constexpr size_t ChunksPerThread = 4;
+		static constexpr size_t MinChunkSize = 1024;
+
+		template<typename E>
+		Self& run(const E* values, size_t size, unsigned characteristics)
+		{
+			using SourceType = std::decay_t<decltype(self().source())>;
+			static_assert(std::is_same_v<SourceType, SourceStream<E, const E*>>, "run() needs a pipeline created by stream::pipeline<T>(), over elements of type T");
+
+			self().reset();
+			self().source().rebind(Spliterator<E, const E*>(values, values + size, characteristics, size));
+			return self();
+		}
+
+		struct Nothing
+		{
+
+		};
+
+#if defined(STREAM_PROFILING)
+		PipelineStats::Record* profileRecord(const char* name)
+		{
+			PipelineStats* stats = self().source().m_Options.stats;
+			return stats != nullptr ? &stats->record(&self(), name) : nullptr;
+		}
+
+		template<typename Stage, typename = void>
+		struct HasStageStats : std::false_type
+		{
+
+		};
+
+		template<typename Stage>
+		struct HasStageStats<Stage, std::void_t<decltype(std::declval<const Stage&>().recordStats(std::declval<PipelineStats::Record&>()))>> : std::true_type
+		{
+
+		};
+
+		/*
+			Counts the elements pushed into the sink of a stage, and the nanoseconds spent in it and downstream.
+			The counts are added to the record once the sink ends, so the chunks of parallel pipelines do not
+			contend for it. Without a record, the pipeline is not profiled and elements are passed through
+		*/
+		template<typename Stage, typename Sink>
+		struct ProfiledSink
+		{
+			Stage* m_Stage;
+			Sink m_Sink;
+			PipelineStats::Record* m_Record;
+			uint64_t m_ElementsIn = 0;
+			uint64_t m_Nanoseconds = 0;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				if(m_Record == nullptr)
+				{
+					return m_Sink.accept(std::forward<E>(element));
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				const bool wantsMore = m_Sink.accept(std::forward<E>(element));
+				m_Nanoseconds += elapsed(start);
+				++m_ElementsIn;
+
+				return wantsMore;
+			}
+
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
+			{
+				if(m_Record == nullptr)
+				{
+					return pushBlock(m_Sink, block);
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				const bool wantsMore = pushBlock(m_Sink, block);
+				m_Nanoseconds += elapsed(start);
+				m_ElementsIn += block.size;
+
+				return wantsMore;
+			}
+
+			void end()
+			{
+				if(m_Record == nullptr)
+				{
+					m_Sink.end();
+					return;
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				m_Sink.end();
+				m_Nanoseconds += elapsed(start);
+
+				m_Record->elementsIn.fetch_add(m_ElementsIn, std::memory_order_relaxed);
+				m_Record->nanoseconds.fetch_add(m_Nanoseconds, std::memory_order_relaxed);
+				m_ElementsIn = 0;
+				m_Nanoseconds = 0;
+
+				if constexpr(HasStageStats<Stage>::value)
+				{
+					m_Stage->recordStats(*m_Record);
+				}
+			}
+
+			static uint64_t elapsed(std::chrono::steady_clock::time_point start)
+			{
+				return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+			}
+		};
+#endif
+
+		template<typename Container, typename = void>
+		struct IsReservable : std::false_type
+		{
+
+		};
+
+		template<typename Container>
+		struct IsReservable<Container, std::void_t<decltype(std::declval<Container&>().reserve(size_t()))>> : std::true_type
+		{
+
+		};
+
+		template<typename Container>
+		struct IsArray : std::false_type
+		{
+
+		};
+
+		template<typename E, size_t N>
+		struct IsArray<std::array<E, N>> : std::true_type
+		{
+
+		};
+
+		template<typename Container, typename = void>
+		struct IsRangeInsertable : std::false_type
+		{
+
+		};
+
+		template<typename Container>
+		struct IsRangeInsertable<Container, std::void_t<decltype(std::declval<Container&>().insert(
+			std::end(std::declval<Container&>()), std::begin(std::declval<Container&>()), std::end(std::declval<Container&>())))>> : std::true_type
+		{
+
+		};
+
+		template<typename Container, typename = void>
+		struct UsesMemoryResource : std::false_type
+		{
+
+		};
+
+		template<typename Container>
+		struct UsesMemoryResource<Container, std::void_t<typename Container::allocator_type>>
+			: std::is_convertible<std::pmr::memory_resource*, typename Container::allocator_type>
+		{
+
+		};
+
+		/*
+			Creates an empty container, allocating from the memory resource of the pipeline if it is a pmr container
+		*/
+		template<typename Container>
+		Container makeContainer()
+		{
+			if constexpr(UsesMemoryResource<Container>::value)
+			{
+				return Container(typename Container::allocator_type(memoryResource()));
+			}
+			else
+			{
+				return Container();
+			}
+		}
+
+#if defined(STREAM_HAS_COROUTINES)
+		/*
+			Pushes the elements of the asynchronous source of stream through its pipeline into action,
+			until action returns false. The stream lives in the coroutine frame while it runs
+		*/
+		template<typename Action>
+		static Task<void> evaluateAsync(Self stream, Action action)
+		{
+			auto sink = stream.sinkChain(stream.profileTerminal(TerminalSink<Action>{std::move(action)}));
+			auto& generator = stream.source().m_Generator;
+
+			while(auto element = co_await generator.next())
+			{
+				if(!sink.accept(std::move(element.value())))
+				{
+					break;
+				}
+			}
+
+			sink.end();
+		}
+
+		template<typename Container>
+		static Task<Container> collectAsync(Self stream)
+		{
+			Container container = stream.template makeContainer<Container>();
+
+			co_await evaluateAsync(std::move(stream), [&](auto&& element)
+			{
+				container.insert(std::end(container), std::forward<decltype(element)>(element));
+				return true;
+			});
+
+			co_return container;
+		}
+#endif
+
+		template<typename Partial>
+		struct alignas(64) PartialSlot
+		{
+			Partial m_Value;
+		};
+
+		template<typename Action>
+		struct TerminalSink
+		{
+			Action m_Action;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				return m_Action(std::forward<E>(element));
+			}
+
+			void end()
+			{
+
+			}
+		};
+
+		/*
+			Head of the sink chain of a stream pushed into the sink of another pipeline by pushInto()
+		*/
+		template<typename Sink>
+		struct ForwardingSink
+		{
+			Sink* m_Sink;
+			bool* m_Stopped;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				*m_Stopped = !m_Sink->accept(std::forward<E>(element));
+				return !*m_Stopped;
+			}
+
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
+			{
+				*m_Stopped = !pushBlock(*m_Sink, block);
+				return !*m_Stopped;
+			}
+
+			void end()
+			{
+
+			}
+		};
+
+		/*
+			Shared by the tasks of a parallel evaluation: the chunks from m_FirstCancelled on must stop
+		*/
+		struct Cancellation
+		{
+			std::atomic<size_t> m_FirstCancelled{std::numeric_limits<size_t>::max()};
+
+			bool isCancelled(size_t chunk) const
+			{
+				return chunk >= m_FirstCancelled.load(std::memory_order_relaxed);
+			}
+
+			void cancelFrom(size_t chunk)
+			{
+				size_t firstCancelled = m_FirstCancelled.load(std::memory_order_relaxed);
+				while(chunk < firstCancelled && !m_FirstCancelled.compare_exchange_weak(firstCancelled, chunk, std::memory_order_relaxed))
+				{
+
+				}
+			}
+		};
+
+		/*
+			Head of the sink chain of a chunk, stopping the source before an element enters the pipeline once the chunk is cancelled
+		*/
+		template<typename Sink>
+		struct CancellableSink
+		{
+			Sink* m_Sink;
+			const Cancellation* m_Cancellation;
+			size_t m_Chunk;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				return !m_Cancellation->isCancelled(m_Chunk) && m_Sink->accept(std::forward<E>(element));
+			}
+
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
+			{
+				return !m_Cancellation->isCancelled(m_Chunk) && pushBlock(*m_Sink, block);
+			}
+
+			void end()
+			{
+				m_Sink->end();
+			}
+		};
+
+		template<typename Partial, typename MakeNeutral, typename Accept, typename Combine, typename Chunks>
+		void evaluateParallel(Partial& result, MakeNeutral& makeNeutral, Accept& accept, Combine& combine, ShortCircuit shortCircuit, Executor& executor, Chunks& chunks)
+		{
+			std::vector<PartialSlot<Partial>> partials;
+			partials.reserve(chunks.size() - 1);
+			for(size_t i = 1;i < chunks.size();++i)
+			{
+				partials.push_back(PartialSlot<Partial>{makeNeutral()});
+			}
+
+			Cancellation cancellation;
+
+			executor.parallelFor(chunks.size(), [&](size_t chunk)
+			{
+				if(cancellation.isCancelled(chunk))
+				{
+					return;
+				}
+
+				Partial& partial = chunk == 0 ? result : partials[chunk - 1].m_Value;
+
+				auto action = [&](auto&& element)
+				{
+					if(accept(partial, std::forward<decltype(element)>(element)))
+					{
+						return true;
+					}
+
+					cancellation.cancelFrom(shortCircuit == ShortCircuit::AllChunks ? 0 : chunk + 1);
+					return false;
+				};
+
+				auto sink = self().sinkChain(profileTerminal(TerminalSink<decltype(action)>{action}));
+				CancellableSink<decltype(sink)> head{&sink, &cancellation, chunk};
+				self().source().push(chunks[chunk], head);
+				sink.end();
+			});
+
+			self().source().m_Spliterator.exhaust();
+
+			for(PartialSlot<Partial>& partial : partials)
+			{
+				combine(result, std::move(partial.m_Value));
+			}
+		}
+
+		static constexpr bool isContiguousArithmetic()
+		{
+			if constexpr(IsSourceStream<Self>::value)
+			{
+				return std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && isContiguous<T, typename Self::IteratorType>();
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		// Whether this stream is a source over contiguous elements of an arithmetic type, so
+		// the terminal operations can run SIMD kernels on its elements. There is no SIMD type of bool
+		static constexpr bool IsContiguousArithmetic = isContiguousArithmetic();
+
+		/*
+			Runs result = kernel(result, values, size) on the remaining elements of a contiguous source.
+			If the source is parallel and splittable is true, the kernel is run on chunks of it starting from
+			neutral instead, and the partial results are merged into result with combine(result, partial)
+		*/
+		template<typename Partial, typename Kernel, typename Combine>
+		Partial evaluateContiguous(Partial result, const Partial& neutral, Kernel kernel, Combine combine, bool splittable = true)
+		{
+			auto& source = self().source();
+			const size_t size = source.estimateSize();
+			const T* values = size == 0 ? nullptr : std::addressof(*source.m_Spliterator.current());
+			Executor* executor = source.m_Options.executor;
+
+			const size_t chunks = executor == nullptr || !splittable ? 1 : std::min(executor->concurrency() * ChunksPerThread, size / MinChunkSize);
+
+			if(chunks <= 1)
+			{
+				result = kernel(std::move(result), values, size);
+			}
+			else
+			{
+				std::vector<PartialSlot<Partial>> partials(chunks, PartialSlot<Partial>{neutral});
+
+				executor->parallelFor(chunks, [&](size_t chunk)
+				{
+					const size_t begin = size * chunk / chunks;
+					const size_t end = size * (chunk + 1) / chunks;
+					partials[chunk].m_Value = kernel(std::move(partials[chunk].m_Value), values + begin, end - begin);
+				});
+
+				for(PartialSlot<Partial>& partial : partials)
+				{
+					combine(result, partial.m_Value);
+				}
+			}
+
+			source.exhaust();
+
+			return result;
+		}
+
+		template<typename R>
+		R sumContiguous(R identity)
+		{
+			const bool reassociate = self().source().m_Options.reassociate;
+
+			// Adding the partial sums of chunks changes the order of floating-point additions
+			const bool splittable = reassociate || (kernels::isExactInSimd<R>() && kernels::isExactInSimd<T>());
+
+			return evaluateContiguous(identity, R(), [&](R initial, const T* values, size_t size)
+			{
+				return kernels::sum(values, size, initial, reassociate);
+			},
+			[](R& result, const R& partial) { result += partial; }, splittable);
+		}
+
+		template<bool Less>
+		Optional<T> extremeContiguous()
+		{
+			const bool reassociate = self().source().m_Options.reassociate;
+
+			auto combine = [](Optional<T>& result, const Optional<T>& partial)
+			{
+				if(partial.has_value() && (!result.has_value() || (Less ? partial.value() < result.value() : partial.value() > result.value())))
+				{
+					result = partial;
+				}
+			};
+
+			return evaluateContiguous(Optional<T>(), Optional<T>(), [&](Optional<T> initial, const T* values, size_t size)
+			{
+				if(size > 0)
+				{
+					combine(initial, kernels::extreme<Less>(values, size, reassociate));
+				}
+				return initial;
+			},
+			combine);
+		}
+
+		template<typename Compare>
+		STREAM_CONSTEXPR Optional<T> maxMinInternal(Compare comparator)
+		{
+			Optional<T> result;
+
+			auto accept = [&](Optional<T>& result, auto&& element)
+			{
+				if(!result.has_value() || comparator(element, result.value()))
+				{
+					result = std::forward<decltype(element)>(element);
+				}
+				return true;
+			};
+
+			if(isConstantEvaluated())
+			{
+				pull([&](auto&& element) { return accept(result, std::forward<decltype(element)>(element)); });
+				return result;
+			}
+
+			evaluate(result, accept,
+			[&](Optional<T>& result, Optional<T>&& other)
+			{
+				if(other.has_value() && (!result.has_value() || comparator(other.value(), result.value())))
+				{
+					result = std::move(other);
+				}
+			});
+
+			return result;
+		}
+
+		template<typename Accumulate>
+		STREAM_CONSTEXPR Optional<T> reduceInternal(Optional<T> result, Accumulate& accumulator)
+		{
+			auto accumulate = [&](Optional<T>& result, auto&& element)
+			{
+				if(result.has_value())
+				{
+					result = accumulator(std::move(result.value()), std::forward<decltype(element)>(element));
+				}
+				else
+				{
+					result.emplace(std::forward<decltype(element)>(element));
+				}
+				return true;
+			};
+
+			if(isConstantEvaluated())
+			{
+				pull([&](auto&& element) { return accumulate(result, std::forward<decltype(element)>(element)); });
+				return result;
+			}
+
+			evaluate(result, accumulate, [&](Optional<T>& result, Optional<T>&& other)
+			{
+				if(other.has_value())
+				{
+					accumulate(result, std::move(other.value()));
+				}
+			});
+
+			return result;
+		}
+
+		template<typename Array>
+		STREAM_CONSTEXPR Array collectArray()
+		{
+			Array array{};
+			size_t size = 0;
+
+			auto insert = [&](auto&& element)
+			{
+				if(size == array.size())
+				{
+					throw std::length_error("The stream has more elements than the array holds");
+				}
+
+				array[size++] = std::forward<decltype(element)>(element);
+				return true;
+			};
+
+			if(isConstantEvaluated())
+			{
+				pull(insert);
+			}
+			else
+			{
+				evaluate(insert);
+			}
+
+			return array;
+		}
+
+	};
+
+// ===============================================================================================================================
+
+	/*
+		Keeps the storage of the elements of a source alive, like the std::shared_ptr<const void> it holds.
+		Most sources own nothing: an empty SourceOwner never allocates, and unlike a std::shared_ptr,
+		it may be created and destroyed at compile time
+	*/
+	class SourceOwner
+	{
+	public:
+
+		SourceOwner() = default;
+
+		explicit SourceOwner(std::shared_ptr<const void> owner)
+			: m_Owner(owner != nullptr ? new std::shared_ptr<const void>(std::move(owner)) : nullptr)
+		{
+
+		}
+
+		STREAM_CONSTEXPR SourceOwner(const SourceOwner& other)
+			: m_Owner(other.m_Owner != nullptr ? new std::shared_ptr<const void>(*other.m_Owner) : nullptr)
+		{
+
+		}
+
+		STREAM_CONSTEXPR SourceOwner(SourceOwner&& other) noexcept
+			: m_Owner(std::exchange(other.m_Owner, nullptr))
+		{
+
+		}
+
+		STREAM_CONSTEXPR SourceOwner& operator=(SourceOwner other) noexcept
+		{
+			std::swap(m_Owner, other.m_Owner);
+			return *this;
+		}
+
+		STREAM_CONSTEXPR ~SourceOwner()
+		{
+			delete m_Owner;
+		}
+
+		STREAM_CONSTEXPR void reset()
+		{
+			delete m_Owner;
+			m_Owner = nullptr;
+		}
+
+	private:
+		std::shared_ptr<const void>* m_Owner = nullptr;
+	};
+
+	template<typename T, typename Iterator>
+	class SourceStream : public Stream<T, SourceStream<T, Iterator>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		STREAM_CONSTEXPR explicit SourceStream(Iterator begin, Iterator end)
+			: m_Spliterator(std::move(begin), std::move(end))
+		{
+
+		}
+
+		STREAM_CONSTEXPR explicit SourceStream(Spliterator<T, Iterator> spliterator)
+			: m_Spliterator(std::move(spliterator))
+		{
+
+		}
+
+		/*
+			==> std::shared_ptr<const void> owner: the storage of the elements, e.g. a MappedFile,
+				kept alive as long as this stream or a copy of it
+		*/
+		SourceStream(Spliterator<T, Iterator> spliterator, std::shared_ptr<const void> owner)
+			: m_Spliterator(std::move(spliterator)), m_Owner(std::move(owner))
+		{
+
+		}
+
+	protected:
+
+		STREAM_CONSTEXPR bool hasRemaining()
+		{
+			return m_Spliterator.hasRemaining();
+		}
+
+		STREAM_CONSTEXPR T next()
+		{
+			Iterator& current = m_Spliterator.current();
+			T nextElement = *current;
+			++current;
+			return nextElement;
+		}
+
+		template<typename Sink>
+		void pushRemaining(Sink& sink)
+		{
+			push(m_Spliterator, sink);
+			m_PushBlockSize = 0;
+		}
+
+		/*
+			Pushes the elements of spliterator into sink, one by one or in blocks if the pipeline is batched
+		*/
+		template<typename Sink>
+		void push(Spliterator<T, Iterator>& spliterator, Sink& sink) const
+		{
+			const size_t blockSize = pushBlockSize();
+			if(blockSize > 0)
+			{
+				spliterator.forEachRemainingBlock(sink, blockSize, m_Options.resource != nullptr ? m_Options.resource : std::pmr::get_default_resource());
+			}
+			else
+			{
+				spliterator.forEachRemaining(sink);
+			}
+		}
+
+		/*
+			Makes the next push of a batched pipeline use blocks of at most count elements.
+			Only lasts for that push: the block size of the execution options is kept
+		*/
+		STREAM_CONSTEXPR void limitBlockSize(size_t count)
+		{
+			if(pushBlockSize() > count && count > 0)
+			{
+				m_PushBlockSize = count;
+			}
+		}
+
+		/*
+			Makes the next push use blocks of count elements, unless the pipeline is already batched.
+			Only lasts for that push, like limitBlockSize()
+		*/
+		STREAM_CONSTEXPR void requestBlockSize(size_t count)
+		{
+			if(pushBlockSize() == 0)
+			{
+				m_PushBlockSize = count;
+			}
+		}
+
+		STREAM_CONSTEXPR size_t pushBlockSize() const
+		{
+			return m_PushBlockSize != 0 ? m_PushBlockSize : m_Options.blockSize;
+		}
+
+		STREAM_CONSTEXPR unsigned characteristics() const
+		{
+			return m_Spliterator.characteristics();
+		}
+
+		STREAM_CONSTEXPR size_t estimateSize() const
+		{
+			return m_Spliterator.estimateSize();
+		}
+
+		/*
+			Splits the remaining elements into at most maxChunks spliterators in encounter order,
+			without splitting those with less than 2 * minChunkSize elements. This stream is left untouched
+		*/
+		std::vector<Spliterator<T, Iterator>> split(size_t maxChunks, size_t minChunkSize) const
+		{
+			std::vector<Spliterator<T, Iterator>> chunks{m_Spliterator};
+			size_t splits = 1;
+
+			while(splits > 0 && chunks.size() < maxChunks)
+			{
+				std::vector<Spliterator<T, Iterator>> nextChunks;
+				splits = 0;
+
+				for(Spliterator<T, Iterator>& chunk : chunks)
+				{
+					if(chunks.size() + splits < maxChunks && chunk.estimateSize() >= 2 * minChunkSize)
+					{
+						Optional<Spliterator<T, Iterator>> prefix = chunk.trySplit();
+						if(prefix.has_value())
+						{
+							nextChunks.push_back(std::move(prefix.value()));
+							++splits;
+						}
+					}
+
+					nextChunks.push_back(std::move(chunk));
+				}
+
+				chunks = std::move(nextChunks);
+			}
+
+			return chunks;
+		}
+
+		STREAM_CONSTEXPR size_t skipAhead(size_t count)
+		{
+			return m_Spliterator.skip(count);
+		}
+
+		STREAM_CONSTEXPR void exhaust()
+		{
+			m_Spliterator.exhaust();
+		}
+
+		/*
+			Makes the stream start over with the elements of spliterator, keeping its execution options
+		*/
+		void rebind(Spliterator<T, Iterator> spliterator)
+		{
+			m_Spliterator = std::move(spliterator);
+			m_Owner.reset();
+			m_PushBlockSize = 0;
+		}
+
+	private:
+		using IteratorType = Iterator;
+
+		static constexpr bool IsStateless = true;
+		static constexpr bool IsSplittable = Spliterator<T, Iterator>::IsSplittable;
+
+		Spliterator<T, Iterator> m_Spliterator;
+		ExecutionOptions m_Options;
+		SourceOwner m_Owner;
+		size_t m_PushBlockSize = 0;
+	};
+
+
+// ===============================================================================================================================
+
+	template<typename T, typename PreviousStream, typename Condition>
+	class FilterStream : public Stream<T, FilterStream<T, PreviousStream, Condition>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		STREAM_CONSTEXPR FilterStream(PreviousStream&& previous, Condition condition)
+			: m_Previous(std::move(previous)), m_Condition(std::move(condition))
+		{
+
+		}
+
+	protected:
+		
+		STREAM_CONSTEXPR bool hasRemaining()
+		{
+			m_Next.reset();
+
+			while(m_Previous.hasRemaining())
+			{
+				m_Next = m_Previous.next();
+
+				if(m_Condition(std::as_const(m_Next.value())))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		STREAM_CONSTEXPR T next()
+		{
+			return std::move(m_Next.value());
+		}
+
+		STREAM_CONSTEXPR auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			return m_Previous.sinkChain(this->profileStage("filter", Sink<Downstream>{this, std::move(downstream), std::pmr::vector<uint32_t>(this->memoryResource())}));
+		}
+
+		STREAM_CONSTEXPR unsigned characteristics() const
+		{
+			return m_Previous.characteristics() & ~SIZED;
+		}
+
+		/*
+			Upper bound: every element may pass the filter
+		*/
+		STREAM_CONSTEXPR size_t estimateSize() const
+		{
+			return m_Previous.estimateSize();
+		}
+
+		STREAM_CONSTEXPR void reset()
+		{
+			m_Previous.reset();
+			m_Next.reset();
+		}
+
+	private:
+
+		template<typename Downstream>
+		struct Sink
+		{
+			FilterStream* m_Stream;
+			Downstream m_Downstream;
+
+			std::pmr::vector<uint32_t> m_Selection;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				return !m_Stream->m_Condition(std::as_const(element)) || m_Downstream.accept(std::forward<E>(element));
+			}
+
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
+			{
+				m_Selection.resize(std::max(m_Selection.size(), block.size));
+				uint32_t* selection = m_Selection.data();
+				size_t selected = 0;
+
+				if(block.selection == nullptr)
+				{
+					for(size_t i = 0;i < block.size;++i)
+					{
+						selection[selected] = static_cast<uint32_t>(i);
+						selected += m_Stream->m_Condition(std::as_const(block.values[i])) ? 1 : 0;
+					}
+				}
+				else
+				{
+					for(size_t i = 0;i < block.size;++i)
+					{
+						selection[selected] = block.selection[i];
+						selected += m_Stream->m_Condition(std::as_const(block.values[block.selection[i]])) ? 1 : 0;
+					}
+				}
+
+				return selected == 0 || pushBlock(m_Downstream, Block<E, Movable>{block.values, selection, selected});
+			}
+
+			void end()
+			{
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = PreviousStream::IsStateless;
+
+		PreviousStream m_Previous;
+		Condition m_Condition;
+		Optional<T> m_Next;
+	};
+
+
+// ===============================================================================================================================
+
+	template<typename T, size_t MaxSize, typename PreviousStream>
+	class LimitStream : public Stream<T, LimitStream<T, MaxSize, PreviousStream>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		STREAM_CONSTEXPR explicit LimitStream(PreviousStream&& previous, size_t maxSize = MaxSize)
+			: m_Previous(std::move(previous)), m_MaxSize(maxSize)
+		{
+			m_Previous.limitHint(this->maxSize());
+		}
+
+	protected:
+
+		STREAM_CONSTEXPR bool hasRemaining()
+		{
+			// The count is checked first, so no element is pulled through the previous stages once the limit is reached
+			return m_Count < maxSize() && m_Previous.hasRemaining();
+		}
+
+		STREAM_CONSTEXPR T next()
+		{
+			++m_Count;
+			return m_Previous.next();
+		}
+
+		STREAM_CONSTEXPR auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		/*
+			Batched pipelines push blocks of at most the remaining count, so the stages before
+			the limit, like filters, are not evaluated on a whole block to keep a few elements
+		*/
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			if constexpr(IsSourceStream<std::decay_t<decltype(source())>>::value)
+			{
+				source().limitBlockSize(maxSize() - m_Count);
+			}
+
+			return m_Previous.sinkChain(this->profileStage("limit", Sink<Downstream>{this, std::move(downstream)}));
+		}
+
+		STREAM_CONSTEXPR unsigned characteristics() const
+		{
+			return m_Previous.characteristics();
+		}
+
+		STREAM_CONSTEXPR size_t estimateSize() const
+		{
+			return std::min(m_Previous.estimateSize(), maxSize() - m_Count);
+		}
+
+		STREAM_CONSTEXPR void limitHint(size_t count)
+		{
+			m_Previous.limitHint(std::min(count, maxSize() - m_Count));
+		}
+
+		/*
+			The skipped elements count towards the limit
+		*/
+		STREAM_CONSTEXPR size_t skipAhead(size_t count)
+		{
+			const size_t skipped = m_Previous.skipAhead(std::min(count, maxSize() - m_Count));
+			m_Count += skipped;
+			return skipped;
+		}
+
+		/*
+			The previous stages forget the hints of the last run, e.g. the one of findFirst(), so the bound of the limit is sent again
+		*/
+		STREAM_CONSTEXPR void reset()
+		{
+			m_Previous.reset();
+			m_Count = 0;
+			m_Previous.limitHint(maxSize());
+		}
+
+	private:
+
+		STREAM_CONSTEXPR size_t maxSize() const
+		{
+			if constexpr(MaxSize == DynamicSize)
+			{
+				return m_MaxSize;
+			}
+			else
+			{
+				return MaxSize;
+			}
+		}
+
+		template<typename Downstream>
+		struct Sink
+		{
+			LimitStream* m_Stream;
+			Downstream m_Downstream;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				if(m_Stream->m_Count >= m_Stream->maxSize())
+				{
+					return false;
+				}
+
+				++m_Stream->m_Count;
+
+				return m_Downstream.accept(std::forward<E>(element)) && m_Stream->m_Count < m_Stream->maxSize();
+			}
+
+			void end()
+			{
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = false;
+
+		PreviousStream m_Previous;
+		size_t m_MaxSize;
+		size_t m_Count = 0;
+	};
+
+
+// ===============================================================================================================================
+
+	template<typename T, size_t N, typename PreviousStream>
+	class SkipStream : public Stream<T, SkipStream<T, N, PreviousStream>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		STREAM_CONSTEXPR explicit SkipStream(PreviousStream&& previous, size_t count = N)
+			: m_Previous(std::move(previous)), m_SkipCount(count)
+		{
+
+		}
+
+	protected:
+
+		STREAM_CONSTEXPR bool hasRemaining()
+		{
+			skipInPlace();
+
+			while(m_Count < skipCount() && m_Previous.hasRemaining())
+			{
+				m_Previous.next();
+				++m_Count;
+			}
+
+			return m_Previous.hasRemaining();
+		}
+
+		STREAM_CONSTEXPR T next()
+		{
+			return m_Previous.next();
+		}
+
+		STREAM_CONSTEXPR auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			skipInPlace();
+			return m_Previous.sinkChain(this->profileStage("skip", Sink<Downstream>{this, std::move(downstream)}));
+		}
+
+		STREAM_CONSTEXPR unsigned characteristics() const
+		{
+			return m_Previous.characteristics();
+		}
+
+		STREAM_CONSTEXPR size_t estimateSize() const
+		{
+			const size_t size = m_Previous.estimateSize();
+			const size_t remainingSkips = skipCount() - std::min(m_Count, skipCount());
+
+			if(size == UnknownSize)
+			{
+				return UnknownSize;
+			}
+
+			return size > remainingSkips ? size - remainingSkips : 0;
+		}
+
+		/*
+			The skipped elements are consumed too
+		*/
+		STREAM_CONSTEXPR void limitHint(size_t count)
+		{
+			const size_t remainingSkips = skipCount() - std::min(m_Count, skipCount());
+			m_Previous.limitHint(count > std::numeric_limits<size_t>::max() - remainingSkips ? std::numeric_limits<size_t>::max() : count + remainingSkips);
+		}
+
+		STREAM_CONSTEXPR size_t skipAhead(size_t count)
+		{
+			skipInPlace();
+			return m_Count < skipCount() ? 0 : m_Previous.skipAhead(count);
+		}
+
+		STREAM_CONSTEXPR void reset()
+		{
+			m_Previous.reset();
+			m_Count = 0;
+		}
+
+	private:
+
+		STREAM_CONSTEXPR size_t skipCount() const
+		{
+			if constexpr(N == DynamicSize)
+			{
+				return m_SkipCount;
+			}
+			else
+			{
+				return N;
+			}
+		}
+
+		/*
+			Drops the elements to skip without pulling them through the pipeline
+			if the previous stages allow it, e.g. in O(1) on random-access sources
+		*/
+		STREAM_CONSTEXPR void skipInPlace()
+		{
+			if(m_Count < skipCount())
+			{
+				m_Count += m_Previous.skipAhead(skipCount() - m_Count);
+			}
+		}
+
+		template<typename Downstream>
+		struct Sink
+		{
+			SkipStream* m_Stream;
+			Downstream m_Downstream;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				if(m_Stream->m_Count < m_Stream->skipCount())
+				{
+					++m_Stream->m_Count;
+					return true;
+				}
+
+				return m_Downstream.accept(std::forward<E>(element));
+			}
+
+			void end()
+			{
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = false;
+
+		PreviousStream m_Previous;
+		size_t m_SkipCount;
+		size_t m_Count = 0;
+	};
+
+// ===============================================================================================================================
+
+	template<typename T, typename PreviousStream, typename Less>
+	class SortedStream : public Stream<T, SortedStream<T, PreviousStream, Less>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		SortedStream(PreviousStream&& previous, Less less)
+			: m_Previous(std::move(previous)), m_Less(std::move(less))
+		{
+
+		}
+
+	protected:
+
+		bool hasRemaining()
+		{
+			if(isAlreadySorted())
+			{
+				return m_Previous.hasRemaining();
+			}
+
+			if(!m_Sorted)
+			{
+				bindResource();
+
+				while(m_Previous.hasRemaining())
+				{
+					insert(m_Previous.next());
+				}
+
+				sort();
+			}
+
+			return m_Index < m_Buffer.size();
+		}
+
+		T next()
+		{
+			return isAlreadySorted() ? m_Previous.next() : std::move(m_Buffer[m_Index++]);
+		}
+
+		auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			bindResource();
+			return m_Previous.sinkChain(this->profileStage("sorted", Sink<Downstream>{this, std::move(downstream), isAlreadySorted()}));
+		}
+
+		/*
+			Only the natural order sets SORTED, since DISTINCT relies on it to group equal elements
+		*/
+		unsigned characteristics() const
+		{
+			const unsigned characteristics = m_Previous.characteristics() | ORDERED;
+			return IsNaturalOrder ? characteristics | SORTED : characteristics & ~SORTED;
+		}
+
+		size_t estimateSize() const
+		{
+			return std::min(m_Previous.estimateSize(), m_Bound);
+		}
+
+		/*
+			Only the first count sorted elements will be consumed, so only they are kept
+		*/
+		void limitHint(size_t count)
+		{
+			m_Bound = std::min(m_Bound, count);
+		}
+
+		/*
+			The bound only holds for the last run: the limit() stages after this one send theirs again
+		*/
+		void reset()
+		{
+			m_Previous.reset();
+			m_Buffer.clear();
+			m_Index = 0;
+			m_Sorted = false;
+			m_Bound = std::numeric_limits<size_t>::max();
+		}
+
+	private:
+
+		/*
+			Streams already ORDERED and SORTED are passed through, and SORTED is only set for the natural order of operator<,
+			so other sorts, like std::greater, are redone
+		*/
+		bool isAlreadySorted() const
+		{
+			return IsNaturalOrder && (m_Previous.characteristics() & (ORDERED | SORTED)) == (ORDERED | SORTED);
+		}
+
+		void bindResource()
+		{
+			if(m_Buffer.get_allocator().resource() != this->memoryResource())
+			{
+				m_Buffer = std::pmr::vector<T>(this->memoryResource());
+			}
+		}
+
+		/*
+			Bounded streams keep the smallest m_Bound elements in a max-heap,
+			so the greatest of them is replaced when a smaller element comes
+		*/
+		template<typename E>
+		void insert(E&& element)
+		{
+			if(m_Bound == std::numeric_limits<size_t>::max())
+			{
+				m_Buffer.push_back(std::forward<E>(element));
+			}
+			else if(m_Buffer.size() < m_Bound)
+			{
+				m_Buffer.push_back(std::forward<E>(element));
+
+				if(m_Bound > 1)
+				{
+					std::push_heap(m_Buffer.begin(), m_Buffer.end(), m_Less);
+				}
+			}
+			else if(m_Bound > 0 && m_Less(std::as_const(element), m_Buffer.front()))
+			{
+				// A bound of 1 only keeps the minimum, so no heap is needed
+				if(m_Bound == 1)
+				{
+					m_Buffer.front() = std::forward<E>(element);
+				}
+				else
+				{
+					std::pop_heap(m_Buffer.begin(), m_Buffer.end(), m_Less);
+					m_Buffer.back() = std::forward<E>(element);
+					std::push_heap(m_Buffer.begin(), m_Buffer.end(), m_Less);
+				}
+			}
+		}
+
+		void sort()
+		{
+			Executor* executor = source().m_Options.executor;
+
+			if(m_Bound != std::numeric_limits<size_t>::max())
+			{
+				std::sort_heap(m_Buffer.begin(), m_Buffer.end(), m_Less);
+			}
+			else if(executor != nullptr && executor->concurrency() > 1 && m_Buffer.size() >= MinParallelSortSize)
+			{
+				parallelSort(*executor);
+			}
+			else
+			{
+				std::sort(m_Buffer.begin(), m_Buffer.end(), m_Less);
+			}
+
+			m_Sorted = true;
+		}
+
+		/*
+			Sorts one chunk per thread of the executor, then merges them pairwise
+		*/
+		void parallelSort(Executor& executor)
+		{
+			size_t chunks = 1;
+			while(chunks < executor.concurrency())
+			{
+				chunks *= 2;
+			}
+
+			const size_t size = m_Buffer.size();
+			auto bound = [&](size_t chunk) { return m_Buffer.begin() + static_cast<std::ptrdiff_t>(size * chunk / chunks); };
+
+			executor.parallelFor(chunks, [&](size_t chunk)
+			{
+				std::sort(bound(chunk), bound(chunk + 1), m_Less);
+			});
+
+			for(size_t width = 1;width < chunks;width *= 2)
+			{
+				executor.parallelFor(chunks / (2 * width), [&](size_t pair)
+				{
+					const size_t first = pair * 2 * width;
+					std::inplace_merge(bound(first), bound(first + width), bound(first + 2 * width), m_Less);
+				});
+			}
+		}
+
+		template<typename Downstream>
+		struct Sink
+		{
+			SortedStream* m_Stream;
+			Downstream m_Downstream;
+			bool m_AlreadySorted;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				if(m_AlreadySorted)
+				{
+					return m_Downstream.accept(std::forward<E>(element));
+				}
+
+				m_Stream->insert(std::forward<E>(element));
+				return true;
+			}
+
+			void end()
+			{
+				if(!m_AlreadySorted)
+				{
+					m_Stream->sort();
+
+					auto& buffer = m_Stream->m_Buffer;
+					for(size_t& index = m_Stream->m_Index;index < buffer.size();)
+					{
+						if(!m_Downstream.accept(std::move(buffer[index++])))
+						{
+							break;
+						}
+					}
+				}
+
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = false;
+		static constexpr bool IsNaturalOrder = std::is_same_v<Less, std::less<T>> || std::is_same_v<Less, std::less<>>;
+		static constexpr size_t MinParallelSortSize = 1 << 16;
+
+		PreviousStream m_Previous;
+		Less m_Less;
+		std::pmr::vector<T> m_Buffer;
+		size_t m_Bound = std::numeric_limits<size_t>::max();
+		size_t m_Index = 0;
+		bool m_Sorted = false;
+	};
+
+// ===============================================================================================================================
+
+	template<typename T, typename PreviousStream, typename Set>
+	class DistinctStream : public Stream<T, DistinctStream<T, PreviousStream, Set>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		DistinctStream(PreviousStream&& previous, Set set)
+			: m_Previous(std::move(previous)), m_Set(std::move(set))
+		{
+
+		}
+
+	protected:
+
+		bool hasRemaining()
+		{
+			const Mode mode = this->mode();
+			if(mode == Mode::AlreadyDistinct)
+			{
+				return m_Previous.hasRemaining();
+			}
+
+			bindResource();
+
+			while(m_Previous.hasRemaining())
+			{
+				T nextElement = m_Previous.next();
+				if(isUnique(mode, nextElement))
+				{
+					m_Next = std::move(nextElement);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		T next()
+		{
+			return mode() == Mode::AlreadyDistinct ? m_Previous.next() : std::move(m_Next.value());
+		}
+
+		auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			bindResource();
+			return m_Previous.sinkChain(this->profileStage("distinct", Sink<Downstream>{this, std::move(downstream), mode()}));
+		}
+
+		unsigned characteristics() const
+		{
+			return (m_Previous.characteristics() | DISTINCT) & ~SIZED;
+		}
+
+		/*
+			Upper bound: every element may be unique
+		*/
+		size_t estimateSize() const
+		{
+			return m_Previous.estimateSize();
+		}
+
+		void reset()
+		{
+			m_Previous.reset();
+			m_Set.clear();
+			m_Last.reset();
+			m_Next.reset();
+		}
+
+	private:
+
+		/*
+			How repeated elements are detected:
+
+			==> AlreadyDistinct: elements of DISTINCT sources, like std::set, are passed through without being stored
+			==> Sorted: repeated elements of SORTED streams of totally ordered types are next to each other, so only the last unique one is kept
+			==> Hashed: every unique element is kept in the set
+		*/
+		enum class Mode
+		{
+			AlreadyDistinct,
+			Sorted,
+			Hashed
+		};
+
+		template<typename S, typename = void>
+		struct UsesEqualityOperator : std::false_type
+		{
+
+		};
+
+		template<typename S>
+		struct UsesEqualityOperator<S, std::void_t<typename S::key_equal>>
+			: std::bool_constant<std::is_same_v<typename S::key_equal, std::equal_to<T>> || std::is_same_v<typename S::key_equal, std::equal_to<>>>
+		{
+
+		};
+
+		template<typename U>
+		struct IsString : std::false_type
+		{
+
+		};
+
+		template<typename C, typename Traits, typename Allocator>
+		struct IsString<std::basic_string<C, Traits, Allocator>> : std::true_type
+		{
+
+		};
+
+		template<typename C, typename Traits>
+		struct IsString<std::basic_string_view<C, Traits>> : std::true_type
+		{
+
+		};
+
+		/*
+			SORTED streams are ordered by operator<, but a class may compare only some of its members, e.g. an age,
+			and then elements equal by operator== are not always next to each other. Only the types whose operator<
+			is a total order agreeing with operator== take the Sorted path
+		*/
+		static constexpr bool IsTotallyOrdered = std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T> || IsString<T>::value;
+
+		Mode mode() const
+		{
+			const unsigned characteristics = m_Previous.characteristics();
+
+			if((characteristics & DISTINCT) != 0)
+			{
+				return Mode::AlreadyDistinct;
+			}
+
+			if constexpr(IsTotallyOrdered && UsesEqualityOperator<Set>::value)
+			{
+				if((characteristics & SORTED) != 0)
+				{
+					return Mode::Sorted;
+				}
+			}
+
+			return Mode::Hashed;
+		}
+
+#if defined(STREAM_PROFILING)
+		template<typename S, typename = void>
+		struct HasCapacity : std::false_type
+		{
+
+		};
+
+		template<typename S>
+		struct HasCapacity<S, std::void_t<decltype(std::declval<const S&>().capacity())>> : std::true_type
+		{
+
+		};
+
+		template<typename S, typename = void>
+		struct HasLoadFactor : std::false_type
+		{
+
+		};
+
+		template<typename S>
+		struct HasLoadFactor<S, std::void_t<decltype(std::declval<const S&>().load_factor())>> : std::true_type
+		{
+
+		};
+
+		/*
+			Records the size and load factor of the set, for the sets providing them
+		*/
+		void recordStats(PipelineStats::Record& record) const
+		{
+			if constexpr(HasSize<Set>::value)
+			{
+				record.setSize.store(static_cast<size_t>(std::size(m_Set)), std::memory_order_relaxed);
+
+				if constexpr(HasCapacity<Set>::value)
+				{
+					const size_t capacity = m_Set.capacity();
+					record.loadFactor.store(capacity == 0 ? 0.0 : static_cast<double>(std::size(m_Set)) / static_cast<double>(capacity), std::memory_order_relaxed);
+				}
+				else if constexpr(HasLoadFactor<Set>::value)
+				{
+					record.loadFactor.store(static_cast<double>(m_Set.load_factor()), std::memory_order_relaxed);
+				}
+			}
+		}
+#endif
+
+		template<typename S, typename = void>
+		struct HasResource : std::false_type
+		{
+
+		};
+
+		template<typename S>
+		struct HasResource<S, std::void_t<decltype(std::declval<S&>().setResource(std::declval<std::pmr::memory_resource*>()))>> : std::true_type
+		{
+
+		};
+
+		/*
+			Sets whose memory resource can be changed allocate from the resource of the pipeline
+		*/
+		void bindResource()
+		{
+			if constexpr(HasResource<Set>::value)
+			{
+				m_Set.setResource(this->memoryResource());
+			}
+		}
+
+		bool isUnique(Mode mode, const T& element)
+		{
+			if(mode == Mode::Sorted)
+			{
+				if(m_Last.has_value() && *m_Last == element)
+				{
+					return false;
+				}
+
+				m_Last = element;
+				return true;
+			}
+
+			return m_Set.insert(element).second;
+		}
+
+		template<typename Downstream>
+		struct Sink
+		{
+			DistinctStream* m_Stream;
+			Downstream m_Downstream;
+			Mode m_Mode;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				return (m_Mode != Mode::AlreadyDistinct && !m_Stream->isUnique(m_Mode, element)) || m_Downstream.accept(std::forward<E>(element));
+			}
+
+			void end()
+			{
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = false;
+
+		PreviousStream m_Previous;
+		Set m_Set;
+		Optional<T> m_Last;
+		Optional<T> m_Next;
+	};
+
+// ===============================================================================================================================
+
+	template<typename T, typename R, typename PreviousStream, typename MapFunction>
+	class MapStream : public Stream<R, MapStream<T, R, PreviousStream, MapFunction>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		STREAM_CONSTEXPR MapStream(PreviousStream&& previous, MapFunction mapFunction)
+			: m_Previous(std::move(previous)), m_MapFunction(std::move(mapFunction))
+		{
+
+		}
+
+	protected:
+
+		STREAM_CONSTEXPR bool hasRemaining()
+		{
+			return m_Previous.hasRemaining();
+		}
+
+		STREAM_CONSTEXPR R next()
+		{
+			return m_MapFunction(m_Previous.next());
+		}
+
+		STREAM_CONSTEXPR auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			return m_Previous.sinkChain(this->profileStage("map", Sink<Downstream>{this, std::move(downstream), std::pmr::vector<R>(this->memoryResource())}));
+		}
+
+		STREAM_CONSTEXPR unsigned characteristics() const
+		{
+			return m_Previous.characteristics() & ~(DISTINCT | SORTED);
+		}
+
+		STREAM_CONSTEXPR size_t estimateSize() const
+		{
+			return m_Previous.estimateSize();
+		}
+
+		STREAM_CONSTEXPR void limitHint(size_t count)
+		{
+			m_Previous.limitHint(count);
+		}
+
+		STREAM_CONSTEXPR size_t skipAhead(size_t count)
+		{
+			return m_Previous.skipAhead(count);
+		}
+
+		STREAM_CONSTEXPR void reset()
+		{
+			m_Previous.reset();
+		}
+
+	private:
+
+		template<typename Downstream>
+		struct Sink
+		{
+			MapStream* m_Stream;
+			Downstream m_Downstream;
+
+			std::pmr::vector<R> m_Mapped;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				return m_Downstream.accept(m_Stream->m_MapFunction(std::forward<E>(element)));
+			}
+
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
+			{
+				if constexpr(std::is_default_constructible_v<R> && std::is_move_assignable_v<R>)
+				{
+					m_Mapped.resize(std::max(m_Mapped.size(), block.size));
+					R* mapped = m_Mapped.data();
+
+					for(size_t i = 0;i < block.size;++i)
+					{
+						mapped[i] = m_Stream->m_MapFunction(block.forward(i));
+					}
+				}
+				else
+				{
+					m_Mapped.clear();
+
+					for(size_t i = 0;i < block.size;++i)
+					{
+						m_Mapped.push_back(m_Stream->m_MapFunction(block.forward(i)));
+					}
+				}
+
+				return pushBlock(m_Downstream, Block<R, true>{m_Mapped.data(), nullptr, block.size});
+			}
+
+			void end()
+			{
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = PreviousStream::IsStateless;
+
+		PreviousStream m_Previous;
+		MapFunction m_MapFunction;
+	};
+
+// ===============================================================================================================================
+
+	/*
+		Function of a flatMap(inner, rangeFunction) stage: runs the pipeline inner over the range returned
+		by rangeFunction for an element, and returns the pipeline itself. Ranges returned by value are
+		kept until the next element, since the pipeline only points at their elements
+	*/
+	template<typename T, typename Pipeline, typename RangeFunction>
+	struct InnerPipeline
+	{
+		using Range = std::invoke_result_t<RangeFunction&, T&>;
+
+		Pipeline m_Pipeline;
+		RangeFunction m_RangeFunction;
+		Optional<std::decay_t<Range>> m_Range;
+
+		template<typename E>
+		Pipeline& operator()(E&& element)
+		{
+			if constexpr(std::is_lvalue_reference_v<Range>)
+			{
+				return m_Pipeline.run(m_RangeFunction(element));
+			}
+			else
+			{
+				m_Range.reset();
+				return m_Pipeline.run(m_Range.emplace(m_RangeFunction(element)));
+			}
+		}
+	};
+
+	template<typename T, typename R, typename PreviousStream, typename FlatMapFunction>
+	class FlatMapStream : public Stream<R, FlatMapStream<T, R, PreviousStream, FlatMapFunction>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		FlatMapStream(PreviousStream&& previous, FlatMapFunction flatMapFunction)
+			: m_Previous(std::move(previous)), m_FlatMapFunction(std::move(flatMapFunction))
+		{
+
+		}
+
+	protected:
+
+		/*
+			The inner stream or range of the current element is built in place, in the storage
+			left by the one of the previous element. The element itself is kept alongside it,
+			so inner streams and ranges may refer to it
+		*/
+		bool hasRemaining()
+		{
+			while(!m_Inner.has_value() || !m_Inner->hasRemaining())
+			{
+				if(!m_Previous.hasRemaining())
+				{
+					return false;
+				}
+
+				m_Inner.reset();
+				m_Outer.emplace(m_Previous.next());
+				m_Inner.emplace(m_FlatMapFunction(m_Outer.value()));
+			}
+
+			return true;
+		}
+
+		R next()
+		{
+			return m_Inner->next();
+		}
+
+		auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			return m_Previous.sinkChain(this->profileStage("flatMap", Sink<Downstream>{this, std::move(downstream)}));
+		}
+
+		unsigned characteristics() const
+		{
+			return m_Previous.characteristics() & ORDERED;
+		}
+
+		/*
+			Each element may expand into any number of elements
+		*/
+		size_t estimateSize() const
+		{
+			return m_Previous.estimateSize() == 0 ? 0 : UnknownSize;
+		}
+
+		void reset()
+		{
+			m_Previous.reset();
+			m_Inner.reset();
+			m_Outer.reset();
+		}
+
+	private:
+		using Range = std::invoke_result_t<FlatMapFunction&, T&>;
+
+		static constexpr bool IsInnerStream = IsStream<Range>::value;
+
+		/*
+			Pulls the elements of an inner range, which is kept by reference if the function returned a reference to it
+		*/
+		struct RangeCursor
+		{
+			using Iterator = decltype(std::begin(std::declval<Range&>()));
+
+			Range m_Range;
+			Iterator m_Current;
+			Iterator m_End;
+
+			explicit RangeCursor(Range&& range)
+				: m_Range(std::forward<Range>(range)), m_Current(std::begin(m_Range)), m_End(std::end(m_Range))
+			{
+
+			}
+
+			bool hasRemaining() const
+			{
+				return m_Current != m_End;
+			}
+
+			R next()
+			{
+				R nextElement = *m_Current;
+				++m_Current;
+				return nextElement;
+			}
+		};
+
+		/*
+			Pulls the elements of an inner stream
+		*/
+		struct StreamCursor
+		{
+			// Streams returned by reference, like the pipeline of flatMap(inner, rangeFunction), are kept by reference
+			Range m_Stream;
+
+			explicit StreamCursor(Range&& stream)
+				: m_Stream(std::forward<Range>(stream))
+			{
+
+			}
+
+			bool hasRemaining()
+			{
+				return m_Stream.hasRemaining();
+			}
+
+			R next()
+			{
+				return m_Stream.next();
+			}
+		};
+
+		using Cursor = std::conditional_t<IsInnerStream, StreamCursor, RangeCursor>;
+
+		/*
+			Pushes the elements of an inner stream or range into downstream. Returns false if downstream wants no more elements
+		*/
+		template<typename Inner, typename Downstream>
+		static bool pushInner(Inner&& inner, Downstream& downstream)
+		{
+			if constexpr(IsStream<std::decay_t<Inner>>::value)
+			{
+				return inner.pushInto(downstream);
+			}
+			else
+			{
+				for(auto&& element : inner)
+				{
+					if(!downstream.accept(std::forward<decltype(element)>(element)))
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+		}
+
+		/*
+			The inner stream or range of each element lives on the stack while its elements are pushed, so nothing is allocated
+			for it, but the stages of an inner stream built for each element allocate their own storage, unlike an inner pipeline
+		*/
+		template<typename Downstream>
+		struct Sink
+		{
+			FlatMapStream* m_Stream;
+			Downstream m_Downstream;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				return pushInner(m_Stream->m_FlatMapFunction(std::forward<E>(element)), m_Downstream);
+			}
+
+			void end()
+			{
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		template<typename F>
+		struct IsInnerPipeline : std::false_type
+		{
+
+		};
+
+		template<typename U, typename Pipeline, typename RangeFunction>
+		struct IsInnerPipeline<InnerPipeline<U, Pipeline, RangeFunction>> : std::true_type
+		{
+
+		};
+
+		// Parallel chunks would run the single inner pipeline at once
+		static constexpr bool IsStateless = PreviousStream::IsStateless && !IsInnerPipeline<FlatMapFunction>::value;
+
+		PreviousStream m_Previous;
+		FlatMapFunction m_FlatMapFunction;
+		Optional<T> m_Outer;
+		Optional<Cursor> m_Inner;
+	};
+
+// ===============================================================================================================================
+
+	template<typename T, size_t N, typename PreviousStream>
+	class ChunkStream : public Stream<Span<T>, ChunkStream<T, N, PreviousStream>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		explicit ChunkStream(PreviousStream&& previous, size_t size = N)
+			: m_Previous(std::move(previous)), m_Size(size)
+		{
+			if(size == 0)
+			{
+				throw std::invalid_argument("The size of a chunk must not be zero");
+			}
+		}
+
+	protected:
+
+		bool hasRemaining()
+		{
+			if(m_Ready)
+			{
+				return true;
+			}
+
+			bindBuffer();
+
+			while(m_Buffer.size() < size() && m_Previous.hasRemaining())
+			{
+				m_Buffer.push_back(m_Previous.next());
+			}
+
+			m_Ready = !m_Buffer.empty();
+			return m_Ready;
+		}
+
+		Span<T> next()
+		{
+			m_Ready = false;
+			return Span<T>(m_Buffer.data(), m_Buffer.size());
+		}
+
+		auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		/*
+			Contiguous sources right before the stage push their elements in blocks of a chunk,
+			unless the pipeline is already batched, so their chunks point into the source itself
+		*/
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			if constexpr(IsSourceStream<PreviousStream>::value)
+			{
+				if constexpr(isContiguous<T, typename PreviousStream::IteratorType>())
+				{
+					m_Previous.requestBlockSize(size());
+				}
+			}
+
+			bindBuffer();
+			return m_Previous.sinkChain(this->profileStage("chunk", Sink<Downstream>{this, std::move(downstream), &m_Buffer}));
+		}
+
+		unsigned characteristics() const
+		{
+			return m_Previous.characteristics() & (SIZED | ORDERED);
+		}
+
+		size_t estimateSize() const
+		{
+			const size_t size = m_Previous.estimateSize();
+			return size == UnknownSize ? UnknownSize : size / this->size() + (size % this->size() != 0 ? 1 : 0);
+		}
+
+		void reset()
+		{
+			m_Previous.reset();
+			m_Buffer.clear();
+			m_Ready = false;
+		}
+
+	private:
+
+		size_t size() const
+		{
+			if constexpr(N == DynamicSize)
+			{
+				return m_Size;
+			}
+			else
+			{
+				return N;
+			}
+		}
+
+		/*
+			Empties the buffer, which then holds a whole chunk without growing, but never more elements than the stream has
+		*/
+		void bindBuffer()
+		{
+			if(m_Buffer.get_allocator().resource() != this->memoryResource())
+			{
+				m_Buffer = std::pmr::vector<T>(this->memoryResource());
+			}
+
+			m_Buffer.clear();
+			m_Buffer.reserve(std::min(size(), m_Previous.estimateSize()));
+		}
+
+		template<typename Downstream>
+		struct Sink
+		{
+			ChunkStream* m_Stream;
+			Downstream m_Downstream;
+
+			// The buffer of the stage, which only has one sink as it never runs in parallel
+			std::pmr::vector<T>* m_Buffer;
+			bool m_Stopped = false;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				m_Buffer->push_back(std::forward<E>(element));
+				return m_Buffer->size() < m_Stream->size() || flush();
+			}
+
+			/*
+				Full chunks of unselected blocks of T are passed on in place
+			*/
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
+			{
+				const size_t size = m_Stream->size();
+				size_t i = 0;
+
+				if constexpr(std::is_same_v<std::remove_const_t<E>, T>)
+				{
+					if(block.selection == nullptr)
+					{
+						for(;i < block.size && !m_Buffer->empty();++i)
+						{
+							if(!accept(block.forward(i)))
+							{
+								return false;
+							}
+						}
+
+						for(;block.size - i >= size;i += size)
+						{
+							if(!m_Downstream.accept(Span<T>(block.values + i, size)))
+							{
+								m_Stopped = true;
+								return false;
+							}
+						}
+					}
+				}
+
+				for(;i < block.size;++i)
+				{
+					if(!accept(block.forward(i)))
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			/*
+				The last chunk holds the remaining elements
+			*/
+			void end()
+			{
+				if(!m_Stopped && !m_Buffer->empty())
+				{
+					flush();
+				}
+
+				m_Downstream.end();
+			}
+
+			bool flush()
+			{
+				m_Stopped = !m_Downstream.accept(Span<T>(m_Buffer->data(), m_Buffer->size()));
+				m_Buffer->clear();
+				return !m_Stopped;
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = false;
+
+		PreviousStream m_Previous;
+		size_t m_Size;
+		std::pmr::vector<T> m_Buffer;
+		bool m_Ready = false;
+	};
+
+// ===============================================================================================================================
+
+	template<typename T, size_t N, typename PreviousStream>
+	class SlidingStream : public Stream<Span<T>, SlidingStream<T, N, PreviousStream>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		explicit SlidingStream(PreviousStream&& previous, size_t size = N)
+			: m_Previous(std::move(previous)), m_Size(size)
+		{
+			static_assert(std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>, "sliding() needs default constructible and copy assignable elements");
+
+			if(size == 0)
+			{
+				throw std::invalid_argument("The size of a sliding window must not be zero");
+			}
+		}
+
+	protected:
+
+		bool hasRemaining()
+		{
+			Ring& ring = bindRing();
+
+			while(!m_Ready && m_Previous.hasRemaining())
+			{
+				m_Ready = ring.push(m_Previous.next());
+			}
+
+			return m_Ready;
+		}
+
+		Span<T> next()
+		{
+			m_Ready = false;
+			return m_Ring->window();
+		}
+
+		auto& source()
+		{
+			return m_Previous.source();
+		}
+
+		template<typename Downstream>
+		auto sinkChain(Downstream downstream)
+		{
+			return m_Previous.sinkChain(this->profileStage("sliding", Sink<Downstream>{this, std::move(downstream), &bindRing()}));
+		}
+
+		unsigned characteristics() const
+		{
+			return m_Previous.characteristics() & (SIZED | ORDERED);
+		}
+
+		size_t estimateSize() const
+		{
+			const size_t size = m_Previous.estimateSize();
+			if(size == UnknownSize)
+			{
+				return UnknownSize;
+			}
+
+			// The elements already in the ring take part in the next windows, and once it is full each element ends one
+			const size_t count = m_Ring.has_value() ? m_Ring->count() : 0;
+			const size_t windows = count == m_Size ? size : (count + size + 1 > m_Size ? count + size + 1 - m_Size : 0);
+			return windows + (m_Ready ? 1 : 0);
+		}
+
+		void reset()
+		{
+			m_Previous.reset();
+
+			if(m_Ring.has_value())
+			{
+				m_Ring->clear();
+			}
+
+			m_Ready = false;
+		}
+
+	private:
+
+		/*
+			Ring buffer of the last size elements, each stored twice, at i and i + size,
+			so the window of the last size elements is always contiguous
+		*/
+		class Ring
+		{
+		public:
+
+			Ring(size_t size, std::pmr::memory_resource* resource)
+				: m_Values(2 * size, resource), m_Size(size)
+			{
+
+			}
+
+			/*
+				Adds an element. Returns whether a whole window is now available
+			*/
+			template<typename E>
+			bool push(E&& element)
+			{
+				m_Values[m_Next] = element;
+				m_Values[m_Next + m_Size] = std::forward<E>(element);
+				m_Next = m_Next + 1 == m_Size ? 0 : m_Next + 1;
+				m_Count += m_Count < m_Size ? 1 : 0;
+				return m_Count == m_Size;
+			}
+
+			Span<T> window() const
+			{
+				return Span<T>(m_Values.data() + m_Next, m_Size);
+			}
+
+			size_t size() const
+			{
+				return m_Size;
+			}
+
+			size_t count() const
+			{
+				return m_Count;
+			}
+
+			void clear()
+			{
+				m_Next = 0;
+				m_Count = 0;
+			}
+
+			std::pmr::memory_resource* resource() const
+			{
+				return m_Values.get_allocator().resource();
+			}
+
+		private:
+			std::pmr::vector<T> m_Values;
+			size_t m_Size;
+			size_t m_Next = 0;
+			size_t m_Count = 0;
+		};
+
+		/*
+			The ring of the stage, created on first use
+		*/
+		Ring& bindRing()
+		{
+			if(!m_Ring.has_value() || m_Ring->resource() != this->memoryResource())
+			{
+				m_Ring.emplace(m_Size, this->memoryResource());
+			}
+
+			return *m_Ring;
+		}
+
+		template<typename Downstream>
+		struct Sink
+		{
+			SlidingStream* m_Stream;
+			Downstream m_Downstream;
+
+			// The ring of the stage, which only has one sink as it never runs in parallel
+			Ring* m_Ring;
+
+			template<typename E>
+			bool accept(E&& element)
+			{
+				return !m_Ring->push(std::forward<E>(element)) || m_Downstream.accept(m_Ring->window());
+			}
+
+			/*
+				Windows lying within unselected blocks of T are passed on in place. The ring only
+				gets the elements of the windows starting in a block and ending in the next one
+			*/
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
+			{
+				const size_t size = m_Ring->size();
+
+				if constexpr(std::is_same_v<std::remove_const_t<E>, T>)
+				{
+					if(block.selection == nullptr && block.size >= size)
+					{
+						for(size_t i = 0;i + 1 < size;++i)
+						{
+							if(!accept(block.values[i]))
+							{
+								return false;
+							}
+						}
+
+						for(size_t i = size - 1;i < block.size;++i)
+						{
+							if(!m_Downstream.accept(Span<T>(block.values + i + 1 - size, size)))
+							{
+								return false;
+							}
+						}
+
+						for(size_t i = std::max(size - 1, block.size - size);i < block.size;++i)
+						{
+							m_Ring->push(block.values[i]);
+						}
+
+						return true;
+					}
+				}
+
+				for(size_t i = 0;i < block.size;++i)
+				{
+					if(!accept(block.forward(i)))
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			void end()
+			{
+				m_Downstream.end();
+			}
+		};
+
+	private:
+		static constexpr bool IsStateless = false;
+
+		PreviousStream m_Previous;
+		size_t m_Size;
+		Optional<Ring> m_Ring;
+		bool m_Ready = false;
+	};
+
+// ===============================================================================================================================
+
+	template<typename First, typename Second, typename T>
+	class ZipStream : public Stream<T, ZipStream<First, Second, T>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		ZipStream(First&& first, Second&& second)
+			: m_First(std::move(first)), m_Second(std::move(second))
+		{
+
+		}
+
+	protected:
+
+		bool hasRemaining()
+		{
+			return m_First.hasRemaining() && m_Second.hasRemaining();
+		}
+
+		T next()
+		{
+			auto first = m_First.next();
+			return T(std::move(first), m_Second.next());
+		}
+
+		/*
+			Pairs are sorted if the first elements are sorted and distinct, whatever the second ones are
+		*/
+		unsigned characteristics() const
+		{
+			const unsigned first = m_First.characteristics();
+			const unsigned second = m_Second.characteristics();
+			const unsigned both = first & second & (SIZED | ORDERED);
+			const unsigned distinct = (first | second) & DISTINCT;
+			const unsigned sorted = (first & DISTINCT) != 0 ? first & SORTED : 0;
+			return both | distinct | sorted;
+		}
+
+		size_t estimateSize() const
+		{
+			return std::min(m_First.estimateSize(), m_Second.estimateSize());
+		}
+
+		void limitHint(size_t count)
+		{
+			m_First.limitHint(count);
+			m_Second.limitHint(count);
 		}
 
-		size_t count()
+		void exhaust()
 		{
-			size_t count;
+			m_First.source().exhaust();
+			m_Second.source().exhaust();
+		}
 
-			for(count = 0;hasRemaining();++count)
-			{
-				next();
-			}
+	private:
+		static constexpr bool IsStateless = true;
+		static constexpr bool IsSplittable = false;
+
+		First m_First;
+		Second m_Second;
+		ExecutionOptions m_Options;
+	};
+
+// ===============================================================================================================================
+
+	template<typename T, typename... Streams>
+	class ConcatStream : public Stream<T, ConcatStream<T, Streams...>>
+	{
+		_STREAM_FRIEND_TYPES_
+	public:
+
+		explicit ConcatStream(Streams&&... streams)
+			: m_Streams(std::move(streams)...)
+		{
 
-			return count;
 		}
 
-		Optional<T> findFirst()
+	protected:
+
+		bool hasRemaining()
 		{
-			if(hasRemaining())
-			{
-				return next();
-			}
-			return {};
+			return hasRemainingFrom<0>();
 		}
 
-		void forEach(Consumer<T> consumer)
+		T next()
 		{
-			while(hasRemaining())
-			{
-				consumer(next());
-			}
+			return nextFrom<0>();
 		}
 
-		Optional<T> max()
+		/*
+			Each stream is pushed through its own stages, in turn
+		*/
+		template<typename Sink>
+		void pushRemaining(Sink& sink)
 		{
-			return maxMinInternal([&](T next, T old) -> bool {return next > old;});
+			pushRemainingFrom<0>(sink);
 		}
 
-		Optional<T> max(Comparator<T> comparator)
+		/*
+			The elements of different streams may be equal or out of order, so only a single stream stays DISTINCT or SORTED
+		*/
+		unsigned characteristics() const
 		{
-			return maxMinInternal([&](T next, T old) -> bool {return comparator(next, old) > 0;});
+			const unsigned all = std::apply([](const Streams&... streams) { return (streams.characteristics() & ... & ~0u); }, m_Streams);
+			return sizeof...(Streams) == 1 ? all : all & (SIZED | ORDERED);
 		}
 
-		Optional<T> min()
+		size_t estimateSize() const
 		{
-			return maxMinInternal([&](T next, T old) -> bool {return next < old;});
+			return std::apply([](const Streams&... streams)
+			{
+				size_t size = 0;
+				// Saturates, as any unknown or infinite stream makes the size unknown
+				((size = streams.estimateSize() > UnknownSize - size ? UnknownSize : size + streams.estimateSize()), ...);
+				return size;
+			}, m_Streams);
 		}
 
-		Optional<T> min(Comparator<T> comparator)
+		void exhaust()
 		{
-			return maxMinInternal([&](T next, T old) -> bool {return comparator(next, old) < 0;});
+			std::apply([](Streams&... streams) { (streams.source().exhaust(), ...); }, m_Streams);
+			m_Current = sizeof...(Streams);
 		}
 
-		bool noneMatch(Predicate<T> condition)
+	private:
+
+		template<size_t I>
+		bool hasRemainingFrom()
 		{
-			while(hasRemaining())
+			if constexpr(I == sizeof...(Streams))
+			{
+				return false;
+			}
+			else
 			{
-				if(condition(next()))
+				if(m_Current == I)
 				{
-					return false;
+					if(std::get<I>(m_Streams).hasRemaining())
+					{
+						return true;
+					}
+
+					++m_Current;
 				}
+
+				return hasRemainingFrom<I + 1>();
 			}
-			return true;
 		}
 
-		Optional<T> reduce(Accumulator<T> accumulator)
+		template<size_t I>
+		T nextFrom()
 		{
-			return reduceInternal({}, accumulator);
+			if constexpr(I + 1 == sizeof...(Streams))
+			{
+				return T(std::get<I>(m_Streams).next());
+			}
+			else
+			{
+				return m_Current == I ? T(std::get<I>(m_Streams).next()) : nextFrom<I + 1>();
+			}
 		}
 
-		Optional<T> reduce(const T& identity, Accumulator<T> accumulator)
+		template<size_t I, typename Sink>
+		void pushRemainingFrom(Sink& sink)
 		{
-			return reduceInternal(identity, accumulator);
-		}
+			if constexpr(I < sizeof...(Streams))
+			{
+				if(m_Current == I)
+				{
+					ConvertingSink<Sink> converting{&sink};
+					if(!std::get<I>(m_Streams).pushInto(converting))
+					{
+						return;
+					}
 
-		template<typename R = T>
-		R average(R identity = R())
-		{
-			// Note that T must override operators + and /
-			R result = identity;
-			size_t count = 0;
+					++m_Current;
+				}
 
-			while(hasRemaining())
-			{
-				result += (R) next();
-				++count;
+				pushRemainingFrom<I + 1>(sink);
 			}
-
-			return count == 0 ? identity : result / count;
 		}
 
-	protected:
-
-		virtual bool hasRemaining() = 0;
-		
-		virtual T next() = 0;
-
-	private:
-
-		Optional<T> maxMinInternal(BiPredicate<T, T> comparator)
+		/*
+			Converts the elements of each stream to the common type T before they reach the stages after the concatenation
+		*/
+		template<typename Sink>
+		struct ConvertingSink
 		{
-			Optional<T> result;
+			Sink* m_Sink;
 
-			while(hasRemaining())
+			template<typename E>
+			bool accept(E&& element)
 			{
-				if(result.has_value())
+				if constexpr(std::is_same_v<std::decay_t<E>, T>)
 				{
-					T next_element = next();
-					if(comparator(next_element, result.value()))
-					{
-						result = next_element;
-					}
+					return m_Sink->accept(std::forward<E>(element));
 				}
 				else
 				{
-					result = next();
+					return m_Sink->accept(T(std::forward<E>(element)));
 				}
 			}
 
-			return std::move(result);
-		}
-
-		Optional<T> reduceInternal(Optional<T> result, Accumulator<T> accumulator)
-		{
-			while(hasRemaining())
+			template<typename E, bool Movable>
+			bool acceptBlock(const Block<E, Movable>& block)
 			{
-				result = result.has_value() ? accumulator(result.value(), next()) : next();
+				if constexpr(std::is_same_v<std::remove_const_t<E>, T>)
+				{
+					return pushBlock(*m_Sink, block);
+				}
+				else
+				{
+					for(size_t i = 0;i < block.size;++i)
+					{
+						if(!accept(block.forward(i)))
+						{
+							return false;
+						}
+					}
+
+					return true;
+				}
 			}
+		};
 
-			return std::move(result);
-		}
+	private:
+		static constexpr bool IsStateless = true;
+		static constexpr bool IsSplittable = false;
 
+		std::tuple<Streams...> m_Streams;
+		size_t m_Current = 0;
+		ExecutionOptions m_Options;
 	};
 
 // ===============================================================================================================================
 
-	template<typename T, typename Iterator>
-	class SourceStream : public Stream<T, SourceStream<T, Iterator>>
+	template<typename T, typename Less, typename... Streams>
+	class MergeSortedStream : public Stream<T, MergeSortedStream<T, Less, Streams...>>
 	{
 		_STREAM_FRIEND_TYPES_
 	public:
 
-		explicit SourceStream(Iterator begin, Iterator end)
-			: m_Current(begin), m_End(end)
+		MergeSortedStream(Less less, Streams&&... streams)
+			: m_Streams(std::move(streams)...), m_Less(std::move(less))
 		{
 
 		}
 
 	protected:
 
-		bool hasRemaining() override
+		bool hasRemaining()
 		{
-			return m_Current != m_End;
+			if(!m_Started)
+			{
+				start();
+			}
+
+			return m_Heads[m_Tree[0]].has_value();
 		}
 
-		T next() override
+		T next()
 		{
-			T nextElement = *m_Current;
-			++m_Current;
+			const size_t winner = m_Tree[0];
+			T nextElement = std::move(m_Heads[winner].value());
+			advance(winner);
+			replay(winner);
 			return nextElement;
 		}
 
-	private:
-		Iterator m_Current;
-		const Iterator m_End;
-	};
-
-
-// ===============================================================================================================================
-
-	template<typename T, typename PreviousStream>
-	class FilterStream : public Stream<T, FilterStream<T, PreviousStream>>
-	{
-		_STREAM_FRIEND_TYPES_
-	public:
-
-		FilterStream(PreviousStream* previous, Predicate<T> condition)
-			: m_Previous(*previous), m_Condition(condition)
+		unsigned characteristics() const
 		{
-
+			const unsigned all = std::apply([](const Streams&... streams) { return (streams.characteristics() & ... & ~0u); }, m_Streams);
+			return (all & SIZED) | ORDERED | (IsNaturalOrder ? SORTED : 0u);
 		}
 
-	protected:
-		
-		bool hasRemaining() override
+		size_t estimateSize() const
 		{
-			m_Next.reset();
-
-			while(m_Previous.hasRemaining())
+			return std::apply([this](const Streams&... streams)
 			{
-				m_Next = m_Previous.next();
+				size_t size = 0;
+				((size = streams.estimateSize() > UnknownSize - size ? UnknownSize : size + streams.estimateSize()), ...);
 
-				if(m_Condition(m_Next.value()))
+				// The heads already pulled out of the streams are still to come
+				for(const Optional<T>& head : m_Heads)
 				{
-					return true;
+					size += head.has_value() && size != UnknownSize ? 1 : 0;
 				}
-			}
 
-			return false;
+				return size;
+			}, m_Streams);
 		}
 
-		T next() override
+		void exhaust()
 		{
-			return m_Next.value();
+			std::apply([](Streams&... streams) { (streams.source().exhaust(), ...); }, m_Streams);
+			for(Optional<T>& head : m_Heads)
+			{
+				head.reset();
+			}
+			m_Started = true;
 		}
 
 	private:
-		PreviousStream m_Previous;
-		Predicate<T> m_Condition;
-		Optional<T> m_Next;
-	};
-
+		static constexpr size_t N = sizeof...(Streams);
+		static constexpr bool IsNaturalOrder = std::is_same_v<Less, std::less<T>> || std::is_same_v<Less, std::less<>>;
+
+		/*
+			Whether the head of stream i comes out before the head of stream j. Exhausted streams come last,
+			and equal heads in the order of their streams, so the merge is stable
+		*/
+		bool wins(size_t i, size_t j)
+		{
+			if(!m_Heads[i].has_value() || !m_Heads[j].has_value())
+			{
+				return m_Heads[i].has_value();
+			}
 
-// ===============================================================================================================================
+			if(m_Less(*m_Heads[j], *m_Heads[i]))
+			{
+				return false;
+			}
 
-	template<typename T, size_t MaxSize, typename PreviousStream>
-	class LimitStream : public Stream<T, LimitStream<T, MaxSize, PreviousStream>>
-	{
-		_STREAM_FRIEND_TYPES_
-	public:
+			return i < j || m_Less(*m_Heads[i], *m_Heads[j]);
+		}
 
-		LimitStream(PreviousStream* previous)
-			: m_Previous(*previous)
+		template<size_t I>
+		static void advance(MergeSortedStream& stream)
 		{
+			auto& source = std::get<I>(stream.m_Streams);
+			if(source.hasRemaining())
+			{
+				stream.m_Heads[I].emplace(source.next());
+			}
+			else
+			{
+				stream.m_Heads[I].reset();
+			}
+		}
 
+		template<size_t... I>
+		static constexpr std::array<void (*)(MergeSortedStream&), N> makeAdvances(std::index_sequence<I...>)
+		{
+			return {&advance<I>...};
 		}
 
-	protected:
+		/*
+			Replaces the head of stream i with its next element, through a table as the streams have different types
+		*/
+		void advance(size_t i)
+		{
+			static constexpr std::array<void (*)(MergeSortedStream&), N> advances = makeAdvances(std::make_index_sequence<N>());
+			advances[i](*this);
+		}
 
-		bool hasRemaining() override
+		/*
+			Pulls the first element of every stream, then plays the loser tree: leaf i is at node N + i,
+			and each inner node below the root keeps the stream which lost the match played there
+		*/
+		void start()
 		{
-			return m_Previous.hasRemaining() && m_Count < MaxSize;
+			m_Started = true;
+
+			std::array<size_t, 2 * N> winners{};
+			for(size_t i = 0;i < N;++i)
+			{
+				advance(i);
+				winners[N + i] = i;
+			}
+
+			for(size_t node = N - 1;node >= 1;--node)
+			{
+				const size_t left = winners[2 * node];
+				const size_t right = winners[2 * node + 1];
+				const bool leftWins = wins(left, right);
+				winners[node] = leftWins ? left : right;
+				m_Tree[node] = leftWins ? right : left;
+			}
+
+			m_Tree[0] = N == 1 ? 0 : winners[1];
 		}
 
-		T next() override
+		/*
+			Replays the matches on the path of winner, whose head changed, from its leaf up to the root
+		*/
+		void replay(size_t winner)
 		{
-			++m_Count;
-			return m_Previous.next();
+			for(size_t node = (N + winner) / 2;node >= 1;node /= 2)
+			{
+				if(wins(m_Tree[node], winner))
+				{
+					std::swap(m_Tree[node], winner);
+				}
+			}
+
+			m_Tree[0] = winner;
 		}
 
 	private:
-		PreviousStream m_Previous;
-		size_t m_Count = 0;
+		static constexpr bool IsStateless = true;
+		static constexpr bool IsSplittable = false;
+
+		std::tuple<Streams...> m_Streams;
+		Less m_Less;
+		std::array<Optional<T>, N> m_Heads;
+		std::array<size_t, N> m_Tree{};
+		bool m_Started = false;
+		ExecutionOptions m_Options;
 	};
 
-
 // ===============================================================================================================================
 
-	template<typename T, size_t N, typename PreviousStream>
-	class SkipStream : public Stream<T, SkipStream<T, N, PreviousStream>>
+	template<typename T, bool Copyable>
+	class AnyStream : public Stream<T, AnyStream<T, Copyable>>
 	{
 		_STREAM_FRIEND_TYPES_
 	public:
 
-		SkipStream(PreviousStream* previous)
-			: m_Previous(*previous)
+		template<typename Wrapped, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Wrapped>, AnyStream> && (!Copyable || std::is_copy_constructible_v<Wrapped>)>>
+		AnyStream(Wrapped stream)
+			: m_Stream(std::make_unique<Model<Wrapped>>(std::move(stream)))
 		{
 
 		}
 
+		AnyStream(const AnyStream& other) = default;
+
+		AnyStream(AnyStream&& other) = default;
+
 	protected:
 
-		bool hasRemaining() override
+		bool hasRemaining()
 		{
-			while(m_Count < N && m_Previous.hasRemaining())
-			{
-				m_Previous.next();
-				++m_Count;
-			}
+			return m_Stream->hasRemaining();
+		}
 
-			return m_Previous.hasRemaining();
+		T next()
+		{
+			return m_Stream->next();
 		}
 
-		T next() override
+		unsigned characteristics() const
 		{
-			return m_Previous.next();
+			return m_Stream->characteristics();
 		}
 
-	private:
-		PreviousStream m_Previous;
-		size_t m_Count = 0;
-	};
+		size_t estimateSize() const
+		{
+			return m_Stream->estimateSize();
+		}
 
-// ===============================================================================================================================
+		void exhaust()
+		{
+			while(hasRemaining())
+			{
+				next();
+			}
+		}
 
-	template<typename T, typename PreviousStream>
-	class DistinctStream : public Stream<T, DistinctStream<T, PreviousStream>>
-	{
-		_STREAM_FRIEND_TYPES_
-	public:
+	private:
 
-		DistinctStream(PreviousStream* previous)
-			: m_Previous(*previous)
+		struct Concept
 		{
+			virtual ~Concept() {}
 
-		}
+			virtual bool hasRemaining() = 0;
 
-	protected:
+			virtual T next() = 0;
+
+			virtual unsigned characteristics() const = 0;
 
-		bool hasRemaining() override
+			virtual size_t estimateSize() const = 0;
+
+			virtual std::unique_ptr<Concept> clone() const = 0;
+		};
+
+		template<typename Wrapped>
+		struct Model : public Concept
 		{
-			while(m_Previous.hasRemaining())
+			Wrapped m_Wrapped;
+
+			explicit Model(Wrapped wrapped)
+				: m_Wrapped(std::move(wrapped))
 			{
-				T nextElement = m_Previous.next();
-				if(m_Set.insert(nextElement).second)
+
+			}
+
+			bool hasRemaining() override
+			{
+				return m_Wrapped.hasRemaining();
+			}
+
+			T next() override
+			{
+				return m_Wrapped.next();
+			}
+
+			unsigned characteristics() const override
+			{
+				return m_Wrapped.characteristics();
+			}
+
+			size_t estimateSize() const override
+			{
+				return m_Wrapped.estimateSize();
+			}
+
+			// Only copyable AnyStreams clone their stream, and they only wrap copyable ones
+			std::unique_ptr<Concept> clone() const override
+			{
+				if constexpr(Copyable)
 				{
-					m_Next = nextElement;
-					return true;
+					return std::make_unique<Model>(m_Wrapped);
+				}
+				else
+				{
+					return nullptr;
 				}
 			}
+		};
 
-			return false;
-		}
-
-		T next() override
+		/*
+			Owns the wrapped stream of a copyable AnyStream, and clones it when copied
+		*/
+		struct CloningPointer
 		{
-			return m_Next.value();
-		}
+			std::unique_ptr<Concept> m_Pointer;
+
+			CloningPointer(std::unique_ptr<Concept> pointer)
+				: m_Pointer(std::move(pointer))
+			{
+
+			}
+
+			CloningPointer(const CloningPointer& other)
+				: m_Pointer(other.m_Pointer != nullptr ? other.m_Pointer->clone() : nullptr)
+			{
+
+			}
+
+			CloningPointer(CloningPointer&& other) = default;
 
+			Concept* operator->() const
+			{
+				return m_Pointer.get();
+			}
+		};
 
 	private:
-		PreviousStream m_Previous;
-		std::unordered_set<T> m_Set;
-		Optional<T> m_Next;
+		static constexpr bool IsStateless = true;
+		static constexpr bool IsSplittable = false;
+
+		std::conditional_t<Copyable, CloningPointer, std::unique_ptr<Concept>> m_Stream;
+		ExecutionOptions m_Options;
 	};
 
+#if defined(STREAM_HAS_COROUTINES)
+
 // ===============================================================================================================================
 
-	template<typename T, typename R, typename PreviousStream>
-	class MapStream : public Stream<R, MapStream<T, R, PreviousStream>>
+	template<typename T, typename Generator>
+	class AsyncSourceStream : public Stream<T, AsyncSourceStream<T, Generator>>
 	{
 		_STREAM_FRIEND_TYPES_
 	public:
 
-		MapStream(PreviousStream* previous, Function<T, R> mapFunction)
-			: m_Previous(*previous), m_MapFunction(mapFunction)
+		explicit AsyncSourceStream(Generator generator)
+			: m_Generator(std::move(generator))
 		{
 
 		}
 
 	protected:
 
-		bool hasRemaining() override
+		bool hasRemaining()
 		{
-			return m_Previous.hasRemaining();
+			static_assert(sizeof(Generator) == 0, "Asynchronous streams are consumed with forEachAsync() or collectAsync()");
+			return false;
 		}
 
-		R next() override
+		T next()
 		{
-			return m_MapFunction(m_Previous.next());
+			static_assert(sizeof(Generator) == 0, "Asynchronous streams are consumed with forEachAsync() or collectAsync()");
+			return T();
+		}
+
+		void exhaust()
+		{
+			static_assert(sizeof(Generator) == 0, "Asynchronous streams are consumed with forEachAsync() or collectAsync()");
+		}
+
+		unsigned characteristics() const
+		{
+			return ORDERED;
 		}
 
+		size_t estimateSize() const
+		{
+			return UnknownSize;
+		}
 
 	private:
-		PreviousStream m_Previous;
-		Function<T, R> m_MapFunction;
+		static constexpr bool IsStateless = true;
+		static constexpr bool IsSplittable = false;
+
+		Generator m_Generator;
+		ExecutionOptions m_Options;
 	};
+
+#endif
+
+// ===============================================================================================================================
+
+	// The sources that are not templates are defined once SourceStream is complete
+
+	inline SourceStream<std::string_view, LineIterator> lines(std::shared_ptr<const MappedFile> file)
+	{
+		const char* begin = file->data();
+		const char* end = begin + file->size();
+
+		return SourceStream<std::string_view, LineIterator>(Spliterator<std::string_view, LineIterator>(
+			LineIterator(begin, end), LineIterator(end, end)), std::move(file));
+	}
+
+	inline SourceStream<std::string_view, LineIterator> lines(const std::string& path)
+	{
+		return lines(std::make_shared<const MappedFile>(path));
+	}
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "streams.hpp"
+#include "test.hpp"
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+/*
+	C++20 features: compile-time evaluation and asynchronous sources
+*/
+
+#if defined(STREAM_HAS_CONSTEXPR)
+
+namespace
+{
+	constexpr std::array<int, 8> Data{3, 1, 4, 1, 5, 9, 2, 6};
+
+	constexpr auto Squares = stream::range(0, 4).map([](int i) { return i * i; }).collect<std::array<int, 4>>();
+
+	static_assert(Squares[0] == 0 && Squares[3] == 9);
+	static_assert(stream::of(Data).count() == 8);
+	static_assert(stream::of(Data).filter([](int x) { return x > 2; }).count() == 5);
+	static_assert(*stream::of(Data).min() == 1 && *stream::of(Data).max() == 9);
+	static_assert(*stream::of(Data).reduce(std::plus<int>()) == 31);
+	static_assert(*stream::of(Data).skip(2).limit(3).reduce(0, std::plus<>()) == 10);
+	static_assert(stream::range(0.0, 1.0, 0.25).count() == 4 && stream::range(0.0, 1.0, 0.3).count() == 4);
+}
+
+TEST_CASE(arrayCollectAtRuntime)
+{
+	std::vector<int> values(Data.begin(), Data.end());
+
+	auto large = stream::of(values).filter([](int x) { return x > 2; }).collect<std::array<int, 5>>();
+	CHECK_EQ(large, (std::array<int, 5>{3, 4, 5, 9, 6}));
+
+	auto padded = stream::of(values).limit(2).collect<std::array<int, 3>>();
+	CHECK_EQ(padded, (std::array<int, 3>{3, 1, 0}));
+
+	CHECK_THROWS(std::length_error, stream::of(values).collect<std::array<int, 3>>());
+}
+
+#endif
+
+#if defined(STREAM_HAS_COROUTINES)
+
+namespace
+{
+	stream::AsyncGenerator<int> numbers(int count)
+	{
+		for(int i = 0;i < count;++i)
+		{
+			co_yield i;
+		}
+	}
+}
+
+TEST_CASE(collectAndForEach)
+{
+	auto values = stream::syncWait(stream::fromAsync(numbers(100)).filter([](int x) { return x % 3 == 0; }).collectAsync<std::vector<int>>());
+	CHECK_EQ(values.size(), 34u);
+
+	std::vector<int> seen;
+	stream::syncWait(stream::fromAsync(numbers(1000000)).limit(3).forEachAsync([&](int x) { seen.push_back(x); }));
+	CHECK_EQ(seen, (std::vector<int>{0, 1, 2}));
+}
+
+#endif
@@ -0,0 +1,283 @@
+#include "streams.hpp"
+#include "test.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/*
+	Execution modes: parallel, batched, memory resources, profiling, reusable pipelines and aggregators
+*/
+
+namespace
+{
+	std::vector<int> numbers(int count)
+	{
+		std::vector<int> values;
+		for(int i = 0;i < count;++i)
+		{
+			values.push_back((i * 31) % 1000);
+		}
+		return values;
+	}
+
+	bool isEven(int x)
+	{
+		return x % 2 == 0;
+	}
+
+	struct CountingResource : std::pmr::memory_resource
+	{
+		size_t allocations = 0;
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			++allocations;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+		{
+			std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+}
+
+TEST_CASE(parallelMatchesSequential)
+{
+	const std::vector<int> values = numbers(100000);
+	stream::WorkStealingExecutor executor(4);
+
+	auto sequential = stream::of(values).filter(isEven).map([](int x) { return x * 3; }).collect<std::vector<int>>();
+	auto parallel = stream::of(values).parallel(executor).filter(isEven).map([](int x) { return x * 3; }).collect<std::vector<int>>();
+	CHECK_EQ(parallel, sequential);
+
+	CHECK_EQ(stream::of(values).parallel(executor).count(), values.size());
+	CHECK_EQ(*stream::of(values).parallel(executor).filter([](int x) { return x == 999; }).findFirst(), 999);
+
+	const std::list<int> list(values.begin(), values.end());
+	CHECK_EQ(stream::of(list).parallel(executor).filter(isEven).count(), stream::of(values).filter(isEven).count());
+}
+
+TEST_CASE(parallelFindFirstSkipsLaterChunks)
+{
+	const std::vector<int> values = numbers(1000000);
+	stream::WorkStealingExecutor executor(4);
+	std::atomic<size_t> tests{0};
+
+	CHECK_EQ(*stream::of(values).parallel(executor).filter([&](int) { ++tests; return true; }).findFirst(), values[0]);
+	CHECK(tests.load() < values.size());
+}
+
+TEST_CASE(parallelFloatSumsKeepTheirOrder)
+{
+	std::vector<float> values;
+	for(int i = 0;i < 100000;++i)
+	{
+		values.push_back(i % 3 == 0 ? 1e7f : 0.1f * static_cast<float>(i % 7));
+	}
+
+	float sum = 0;
+	double wideSum = 0;
+	for(float value : values)
+	{
+		sum += value;
+		wideSum += value;
+	}
+
+	stream::WorkStealingExecutor executor(4);
+	CHECK_EQ(*stream::of(values).parallel(executor).reduce(std::plus<float>()), sum);
+	CHECK_EQ(stream::of(values).parallel(executor).average<double>(), wideSum / values.size());
+}
+
+TEST_CASE(batchedMatchesElementWise)
+{
+	const std::vector<int> values = numbers(10000);
+
+	auto elementWise = stream::of(values).filter(isEven).distinct().map([](int x) { return std::to_string(x); }).collect<std::vector<std::string>>();
+	auto batched = stream::of(values).batched(256).filter(isEven).distinct().map([](int x) { return std::to_string(x); }).collect<std::vector<std::string>>();
+	CHECK_EQ(batched, elementWise);
+
+	const std::list<int> list(values.begin(), values.end());
+	CHECK_EQ(stream::of(list).batched(100).filter(isEven).count(), stream::of(values).filter(isEven).count());
+}
+
+TEST_CASE(batchedRejectsBlocksBeyond32Bits)
+{
+	const std::vector<int> values = numbers(10);
+
+	CHECK_EQ(stream::of(values).batched(std::numeric_limits<uint32_t>::max()).filter(isEven).count(), stream::of(values).filter(isEven).count());
+	if constexpr(sizeof(size_t) > sizeof(uint32_t))
+	{
+		CHECK_THROWS(std::invalid_argument, stream::of(values).batched(size_t(std::numeric_limits<uint32_t>::max()) + 1));
+	}
+}
+
+TEST_CASE(memoryResource)
+{
+	const std::vector<int> values = numbers(10000);
+	std::pmr::monotonic_buffer_resource arena;
+
+	auto result = stream::of(values).withResource(&arena).distinct().collect<std::pmr::vector<int>>();
+	CHECK_EQ(result.size(), 1000u);
+	CHECK_EQ(result.get_allocator().resource(), &arena);
+}
+
+TEST_CASE(distinctAllocatesItsSetOnce)
+{
+	const std::vector<int> values = numbers(10000);
+	CountingResource defaults;
+	CountingResource pipeline;
+
+	std::pmr::memory_resource* previous = std::pmr::set_default_resource(&defaults);
+	const size_t count = stream::of(values).withResource(&pipeline).distinct(1000).count();
+	std::pmr::set_default_resource(previous);
+
+	CHECK_EQ(count, 1000u);
+	CHECK_EQ(defaults.allocations, 0u);
+	// The control bytes and the slots, sized once for the 1000 elements
+	CHECK_EQ(pipeline.allocations, 2u);
+}
+
+TEST_CASE(flatMapReusesItsInnerPipeline)
+{
+	auto lines = [](int count) { return std::vector<std::string>(count, "to be or not to be"); };
+	auto tokenize = [tokens = std::vector<std::string_view>()](const std::string& line) mutable -> const std::vector<std::string_view>&
+	{
+		tokens.clear();
+		for(size_t begin = 0, end = 0;begin < line.size();begin = end + 1)
+		{
+			end = std::min(line.find(' ', begin), line.size());
+			tokens.push_back(std::string_view(line).substr(begin, end - begin));
+		}
+		return tokens;
+	};
+
+	auto allocationsFor = [&](int count)
+	{
+		const std::vector<std::string> text = lines(count);
+		CountingResource counting;
+		std::pmr::memory_resource* previous = std::pmr::set_default_resource(&counting);
+		const size_t words = stream::of(text).flatMap(stream::pipeline<std::string_view>().distinct(), tokenize).count();
+		std::pmr::set_default_resource(previous);
+
+		CHECK_EQ(words, 4u * count);
+		return counting.allocations;
+	};
+
+	// The set of the inner distinct() is allocated for the first line only
+	CHECK(allocationsFor(1) > 0);
+	CHECK_EQ(allocationsFor(100), allocationsFor(1));
+
+	const std::vector<std::string> text = lines(2);
+	auto pulled = stream::AnyStream<std::string_view>(stream::of(text).flatMap(stream::pipeline<std::string_view>().distinct(), tokenize));
+	CHECK_EQ(pulled.count(), 8u);
+}
+
+TEST_CASE(profiling)
+{
+	const std::vector<int> values = numbers(1000);
+	stream::PipelineStats stats;
+
+	CHECK_EQ(stream::of(values).profiled(&stats).filter(isEven).count(), stream::of(values).filter(isEven).count());
+#if defined(STREAM_PROFILING)
+	CHECK(!stats.report().empty());
+#else
+	CHECK(stats.report().empty());
+#endif
+}
+
+TEST_CASE(reusablePipelines)
+{
+	auto pipeline = stream::pipeline<int>().filter(isEven).distinct().map([](int x) { return x * 10; });
+
+	std::vector<int> first{1, 2, 2, 4};
+	std::vector<int> second{4, 6, 7};
+
+	CHECK_EQ(pipeline.run(first).collect<std::vector<int>>(), (std::vector<int>{20, 40}));
+	CHECK_EQ(pipeline.run(second).collect<std::vector<int>>(), (std::vector<int>{40, 60}));
+	CHECK_EQ(pipeline.run(second.data(), 1).count(), 1u);
+}
+
+TEST_CASE(reusablePipelinesForgetTerminalHints)
+{
+	std::vector<int> first{3, 1, 2};
+	std::vector<int> second{8, 5, 7, 6};
+
+	auto sorted = stream::pipeline<int>().sorted();
+	CHECK_EQ(*sorted.run(first).findFirst(), 1);
+	CHECK_EQ(sorted.run(second).collect<std::vector<int>>(), (std::vector<int>{5, 6, 7, 8}));
+	CHECK_EQ(sorted.run(second).count(), 4u);
+	CHECK_EQ(*sorted.run(second).max(), 8);
+
+	// The bound of the limit holds for every run
+	auto smallest = stream::pipeline<int>().sorted().skip(1).limit(2);
+	CHECK_EQ(*smallest.run(second).findFirst(), 6);
+	CHECK_EQ(smallest.run(second).collect<std::vector<int>>(), (std::vector<int>{6, 7}));
+	CHECK_EQ(smallest.run(first).count(), 2u);
+	CHECK_EQ(smallest.run(second).collect<std::vector<int>>(), (std::vector<int>{6, 7}));
+}
+
+TEST_CASE(reusablePipelinesKeepTheirBlockSize)
+{
+	std::vector<int> values(64, 1);
+	int tests = 0;
+	auto counted = [&](int) { ++tests; return true; };
+
+	// Each run pushes blocks of at most the remaining count of the limit, without changing the options
+	auto limited = stream::pipeline<int>().batched(64).filter(counted).limit(3);
+	for(int run = 0;run < 3;++run)
+	{
+		tests = 0;
+		CHECK_EQ(limited.run(values).count(), 3u);
+		CHECK_EQ(tests, 3);
+	}
+
+	tests = 0;
+	CHECK_EQ(limited.run(values.data(), 2).count(), 2u);
+	CHECK_EQ(tests, 2);
+}
+
+TEST_CASE(aggregatorWindows)
+{
+	std::vector<int> values{3, 1, 4, 1, 5, 9, 2, 6};
+	std::vector<long> windows;
+
+	auto sums = stream::aggregator<int>(stream::collectors::summing(), stream::Window::tumbling(3), [&](long sum) { windows.push_back(sum); });
+	stream::of(values).aggregate(sums);
+
+	CHECK_EQ(windows, (std::vector<long>{8, 15}));
+	CHECK_EQ(sums.snapshot(), 8);
+	CHECK_EQ(*sums.lastWindow(), 15);
+	CHECK_THROWS(std::invalid_argument, stream::Window::tumbling(0));
+}
+
+TEST_CASE(aggregatorSnapshotsWhileRunning)
+{
+	auto count = stream::aggregator<int>(stream::collectors::counting());
+	std::thread feed([&]() { stream::generate([]() { return 1; }).aggregate(count); });
+
+	size_t last = 0;
+	while(last < 10000)
+	{
+		const size_t snapshot = count.snapshot();
+		CHECK(snapshot >= last);
+		last = snapshot;
+	}
+
+	count.stop();
+	feed.join();
+	CHECK(count.isStopped());
+}
@@ -0,0 +1,33 @@
+#include "test.hpp"
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : "";
+	size_t run = 0;
+
+	for(const test::Case& testCase : test::cases())
+	{
+		if(std::strstr(testCase.name, filter) == nullptr)
+		{
+			continue;
+		}
+
+		const size_t failures = test::failures();
+
+		try
+		{
+			testCase.run();
+		}
+		catch(const std::exception& exception)
+		{
+			test::fail(testCase.name, 0, std::string("unexpected exception: ") + exception.what());
+		}
+
+		std::cout << (test::failures() == failures ? "[  OK  ] " : "[ FAIL ] ") << testCase.name << std::endl;
+		++run;
+	}
+
+	std::cout << run << " tests, " << test::failures() << " failures" << std::endl;
+	return test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#include "streams.hpp"
+#include "test.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+	Streams over several sources: zip(), concat() and mergeSorted()
+*/
+
+TEST_CASE(zip)
+{
+	std::vector<int> keys{1, 2, 3};
+	std::vector<std::string> names{"a", "b"};
+
+	auto pairs = stream::zip(stream::of(keys), stream::of(names)).collect<std::vector<std::pair<int, std::string>>>();
+	CHECK_EQ(pairs, (std::vector<std::pair<int, std::string>>{{1, "a"}, {2, "b"}}));
+}
+
+TEST_CASE(concat)
+{
+	std::vector<int> first{1, 2};
+	std::vector<int> second{3};
+
+	CHECK_EQ(stream::concat(stream::of(first), stream::of(second), stream::range(4, 6)).collect<std::vector<int>>(), (std::vector<int>{1, 2, 3, 4, 5}));
+	CHECK_EQ(stream::concat(stream::of(first), stream::of(second)).count(), 3u);
+	CHECK_EQ(stream::concat(stream::of(first), stream::of(second)).limit(2).collect<std::vector<int>>(), (std::vector<int>{1, 2}));
+}
+
+TEST_CASE(concatConvertsToTheCommonType)
+{
+	std::vector<int> integers{3, 5};
+	std::vector<double> reals{3.0};
+	const std::vector<double> halves{1.5, 2.5, 1.5};
+
+	// Generic lambdas see the common type, whether the elements are pushed or pulled
+	auto half = [](auto x) { return x / 2; };
+	CHECK_EQ(stream::concat(stream::of(integers), stream::of(reals)).map(half).collect<std::vector<double>>(), halves);
+	CHECK_EQ(stream::concat(stream::of(integers), stream::of(reals)).batched(2).map(half).collect<std::vector<double>>(), halves);
+
+	stream::AnyStream<double> pulled = stream::concat(stream::of(integers), stream::of(reals)).map(half);
+	CHECK_EQ(pulled.collect<std::vector<double>>(), halves);
+
+	stream::AnyStream<double> lastConverted = stream::concat(stream::of(reals), stream::of(integers)).map(half);
+	CHECK_EQ(lastConverted.collect<std::vector<double>>(), (std::vector<double>{1.5, 1.5, 2.5}));
+}
+
+TEST_CASE(mergeSorted)
+{
+	std::vector<int> first{1, 4, 7};
+	std::vector<int> second{2, 5, 8};
+	std::vector<int> third{3, 6};
+
+	CHECK_EQ(stream::mergeSorted(stream::of(first), stream::of(second), stream::of(third)).collect<std::vector<int>>(), (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+
+	std::vector<int> descending{9, 3};
+	std::vector<int> others{8, 1};
+	CHECK_EQ(stream::mergeSorted([](int a, int b) { return b - a; }, stream::of(descending), stream::of(others)).collect<std::vector<int>>(), (std::vector<int>{9, 8, 3, 1}));
+}
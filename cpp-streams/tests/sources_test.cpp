@@ -0,0 +1,171 @@
+#include "streams.hpp"
+#include "test.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <forward_list>
+#include <fstream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+	Sources: containers, iterators, moving sources, spliterators, generators and memory-mapped files
+*/
+
+TEST_CASE(ofContainer)
+{
+	std::vector<int> values{3, 1, 4, 1, 5};
+	CHECK_EQ(stream::of(values).collect<std::vector<int>>(), values);
+
+	const std::list<int> list(values.begin(), values.end());
+	CHECK_EQ(stream::of(list).count(), 5u);
+
+	int array[] = {1, 2, 3};
+	CHECK_EQ(*stream::of(array, 3).reduce(std::plus<int>()), 6);
+}
+
+TEST_CASE(ofMoveStreamsMoveOnlyElements)
+{
+	std::vector<std::unique_ptr<int>> values;
+	for(int i = 0;i < 10;++i)
+	{
+		values.push_back(std::make_unique<int>(i));
+	}
+
+	auto odd = stream::ofMove(values).filter([](const std::unique_ptr<int>& value) { return *value % 2 == 1; }).collect<std::vector<std::unique_ptr<int>>>();
+
+	REQUIRE(odd.size() == 5u);
+	CHECK_EQ(*odd[0], 1);
+	CHECK_EQ(values[1], nullptr);
+}
+
+namespace
+{
+	struct ModuloEqual
+	{
+		bool operator()(int first, int second) const
+		{
+			return first % 10 == second % 10;
+		}
+	};
+}
+
+TEST_CASE(containerCharacteristics)
+{
+	using namespace stream;
+
+	static_assert(containerCharacteristics<std::set<int>>() == (ORDERED | SORTED | DISTINCT));
+	static_assert(containerCharacteristics<std::multiset<int>>() == (ORDERED | SORTED));
+	static_assert(containerCharacteristics<std::map<int, int>>() == (ORDERED | SORTED | DISTINCT));
+	static_assert(containerCharacteristics<std::unordered_set<int>>() == DISTINCT);
+	static_assert(containerCharacteristics<std::vector<int>>() == ORDERED);
+
+	// Only the default comparisons match operator< and operator==
+	static_assert(containerCharacteristics<std::set<int, std::less<>>>() == (ORDERED | SORTED | DISTINCT));
+	static_assert(containerCharacteristics<std::set<int, std::greater<>>>() == ORDERED);
+	static_assert(containerCharacteristics<std::multiset<int, std::greater<int>>>() == ORDERED);
+	static_assert(containerCharacteristics<std::unordered_set<int, std::hash<int>, std::equal_to<>>>() == DISTINCT);
+	static_assert(containerCharacteristics<std::unordered_set<int, std::hash<int>, ModuloEqual>>() == 0u);
+
+	// The values of equal keys of a multimap are in insertion order
+	static_assert(containerCharacteristics<std::multimap<int, int>>() == ORDERED);
+}
+
+TEST_CASE(customOrdersAreNotSorted)
+{
+	const std::set<int, std::greater<>> descending{1, 2, 3, 4};
+	CHECK_EQ(stream::of(descending).sorted().collect<std::vector<int>>(), (std::vector<int>{1, 2, 3, 4}));
+	CHECK_EQ(stream::of(descending).distinct().count(), 4u);
+}
+
+TEST_CASE(spliteratorSplitsInHalves)
+{
+	std::vector<int> values(100);
+	stream::Spliterator<int, std::vector<int>::iterator> spliterator(values.begin(), values.end());
+
+	CHECK(spliterator.hasCharacteristics(stream::SIZED | stream::ORDERED));
+
+	auto prefix = spliterator.trySplit();
+	REQUIRE(prefix.has_value());
+	CHECK_EQ(prefix->estimateSize(), 50u);
+	CHECK_EQ(spliterator.estimateSize(), 50u);
+
+	std::forward_list<int> list(5000, 2);
+	stream::Spliterator<int, std::forward_list<int>::iterator> unsized(list.begin(), list.end());
+	CHECK(!unsized.hasCharacteristics(stream::SIZED));
+	CHECK(unsized.trySplit().has_value());
+}
+
+TEST_CASE(range)
+{
+	CHECK_EQ(stream::range(0, 5).collect<std::vector<int>>(), (std::vector<int>{0, 1, 2, 3, 4}));
+	CHECK_EQ(stream::range(10, 0, -3).collect<std::vector<int>>(), (std::vector<int>{10, 7, 4, 1}));
+	CHECK_EQ(stream::range(0, 1000000).skip(999998).count(), 2u);
+	CHECK_THROWS(std::invalid_argument, stream::range(0, 10, 0));
+}
+
+TEST_CASE(floatRangesMayRepeatValues)
+{
+	// Floats near 1e8 are 8 apart, so consecutive values round to the same float
+	const std::vector<float> values = stream::range(1e8f, 1e8f + 100.0f, 1.0f).collect<std::vector<float>>();
+	const std::set<float> unique(values.begin(), values.end());
+
+	CHECK(unique.size() < values.size());
+	CHECK_EQ(stream::range(1e8f, 1e8f + 100.0f, 1.0f).distinct().count(), unique.size());
+}
+
+TEST_CASE(floatRangesTooLongToCount)
+{
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	CHECK_EQ(stream::range(0.0, infinity, 1.0).limit(3).collect<std::vector<double>>(), (std::vector<double>{0, 1, 2}));
+	CHECK_EQ(stream::range(0.0, 1e300, 1.0).skip(2).limit(2).collect<std::vector<double>>(), (std::vector<double>{2, 3}));
+	CHECK_EQ(stream::range(0.0, std::numeric_limits<double>::quiet_NaN()).count(), 0u);
+	CHECK_EQ(stream::range(0.0, -infinity, 1.0).count(), 0u);
+}
+
+TEST_CASE(iterateAndGenerate)
+{
+	CHECK_EQ(stream::iterate(1, [](int x) { return x * 2; }).limit(5).collect<std::vector<int>>(), (std::vector<int>{1, 2, 4, 8, 16}));
+
+	int calls = 0;
+	auto values = stream::generate([&]() { return ++calls; }).limit(3).collect<std::vector<int>>();
+	CHECK_EQ(values, (std::vector<int>{1, 2, 3}));
+	CHECK_EQ(calls, 3);
+}
+
+#if defined(STREAM_HAS_MMAP)
+TEST_CASE(mappedFiles)
+{
+	const std::string path = std::filesystem::temp_directory_path().string() + "/" + "streams_lines.txt";
+	{
+		std::ofstream out(path);
+		out << "first\n\nthird\nlast";
+	}
+
+	// The views point into the mapping, which must outlive them
+	auto file = std::make_shared<const stream::MappedFile>(path);
+	auto lines = stream::lines(file).collect<std::vector<std::string_view>>();
+	CHECK_EQ(lines, (std::vector<std::string_view>{"first", "", "third", "last"}));
+
+	const std::string binary = std::filesystem::temp_directory_path().string() + "/" + "streams_ints.bin";
+	{
+		std::ofstream out(binary, std::ios::binary);
+		for(int i = 0;i < 1000;++i)
+		{
+			out.write(reinterpret_cast<const char*>(&i), sizeof(i));
+		}
+	}
+
+	CHECK_EQ(*stream::mmap<int>(binary).reduce(0, std::plus<int>()), 999 * 1000 / 2);
+	CHECK_THROWS(std::runtime_error, stream::lines("/nonexistent/streams"));
+
+	std::remove(path.c_str());
+	std::remove(binary.c_str());
+}
+#endif
@@ -0,0 +1,375 @@
+#include "streams.hpp"
+#include "test.hpp"
+#include <functional>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+	Intermediate operations, including their fusion and the elements they pull
+*/
+
+namespace
+{
+	// Ordered by age only, while equality compares every member
+	struct Person
+	{
+		int age;
+		std::string name;
+
+		bool operator==(const Person& other) const
+		{
+			return age == other.age && name == other.name;
+		}
+
+		bool operator<(const Person& other) const
+		{
+			return age < other.age;
+		}
+	};
+
+	struct ByAge
+	{
+		bool operator()(const Person& a, const Person& b) const
+		{
+			return a.age < b.age;
+		}
+	};
+}
+
+template<>
+struct std::hash<Person>
+{
+	size_t operator()(const Person& person) const
+	{
+		return std::hash<std::string>()(person.name) ^ std::hash<int>()(person.age);
+	}
+};
+
+namespace
+{
+	// Copies throw once copiesLeft reaches 0, and moves may throw, so growing tables copy it.
+	// The live instances are tracked, so the test sees if the set holds destroyed ones
+	struct FragileCopy
+	{
+		static inline int copiesLeft = -1;
+		static inline std::set<const FragileCopy*> live;
+
+		int value;
+
+		explicit FragileCopy(int value)
+			: value(value)
+		{
+			live.insert(this);
+		}
+
+		FragileCopy(const FragileCopy& other)
+			: value(other.value)
+		{
+			if(copiesLeft == 0)
+			{
+				throw std::runtime_error("copy");
+			}
+			--copiesLeft;
+			live.insert(this);
+		}
+
+		FragileCopy(FragileCopy&& other) noexcept(false)
+			: FragileCopy(static_cast<const FragileCopy&>(other))
+		{
+
+		}
+
+		~FragileCopy()
+		{
+			live.erase(this);
+		}
+
+		bool operator==(const FragileCopy& other) const
+		{
+			return value == other.value;
+		}
+	};
+
+	struct FragileCopyHash
+	{
+		size_t operator()(const FragileCopy& element) const
+		{
+			return std::hash<int>()(element.value);
+		}
+	};
+}
+
+TEST_CASE(filterAndMap)
+{
+	std::vector<int> values{1, 2, 3, 4, 5, 6};
+
+	auto result = stream::of(values).filter([](int x) { return x % 2 == 0; }).map([](int x) { return std::to_string(x); }).collect<std::vector<std::string>>();
+	CHECK_EQ(result, (std::vector<std::string>{"2", "4", "6"}));
+}
+
+TEST_CASE(pushedElementsAreTestedOnce)
+{
+	std::vector<int> values{1, 2, 3, 4, 5, 6};
+	int tests = 0;
+	auto counted = [&](int x) { ++tests; return x % 2 == 0; };
+
+	std::vector<int> seen;
+	stream::of(values).filter(counted).skip<1>().forEach([&](int x) { seen.push_back(x); });
+	CHECK_EQ(seen, (std::vector<int>{4, 6}));
+	CHECK_EQ(tests, 6);
+
+	tests = 0;
+	CHECK(stream::of(values).filter(counted).anyMatch([](int x) { return x == 2; }));
+	CHECK_EQ(tests, 2);
+}
+
+namespace
+{
+	struct CountedCopies
+	{
+		int* copies;
+
+		explicit CountedCopies(int* copies)
+			: copies(copies)
+		{
+
+		}
+
+		CountedCopies(const CountedCopies& other)
+			: copies(other.copies)
+		{
+			++*copies;
+		}
+
+		CountedCopies(CountedCopies&&) = default;
+
+		bool operator()(int x) const
+		{
+			return x > 1;
+		}
+	};
+}
+
+TEST_CASE(stagesMoveTheirUpstream)
+{
+	std::vector<int> values{1, 2, 3, 4};
+	int copies = 0;
+
+	auto pipeline = stream::of(values).filter(CountedCopies(&copies)).map([](int x) { return x * 2; }).skip<1>().limit<5>();
+	CHECK_EQ(copies, 0);
+	CHECK_EQ(std::move(pipeline).collect<std::vector<int>>(), (std::vector<int>{6, 8}));
+}
+
+TEST_CASE(fusedStagesMatchUnfused)
+{
+	std::vector<int> values;
+	for(int i = 0;i < 100;++i)
+	{
+		values.push_back(i);
+	}
+
+	auto fused = stream::of(values).filter([](int x) { return x % 2 == 0; }).filter([](int x) { return x % 3 == 0; })
+		.map([](int x) { return x + 1; }).map([](int x) { return x * 2; }).skip(1).skip<2>().limit(10).limit<5>().collect<std::vector<int>>();
+	CHECK_EQ(fused, (std::vector<int>{38, 50, 62, 74, 86}));
+}
+
+TEST_CASE(distinct)
+{
+	std::vector<int> values{3, 1, 3, 2, 1, 3};
+	CHECK_EQ(stream::of(values).distinct().collect<std::vector<int>>(), (std::vector<int>{3, 1, 2}));
+
+	std::vector<std::string> words{"a", "b", "a"};
+	CHECK_EQ(stream::of(words).distinct().count(), 2u);
+
+	std::set<int> set{1, 2, 3};
+	CHECK_EQ(stream::of(set).distinct().count(), 3u);
+}
+
+TEST_CASE(hashSetsSurviveThrowingCopies)
+{
+	stream::FlatHashSet<FragileCopy, FragileCopyHash> set;
+	int inserted = 0;
+	for(;set.capacity() == 0 || (inserted + 1) * 8 <= static_cast<int>(set.capacity()) * 7;++inserted)
+	{
+		set.insert(FragileCopy(inserted));
+	}
+
+	// Growing copies every element, and the third copy throws
+	FragileCopy::copiesLeft = 3;
+	CHECK_THROWS(std::runtime_error, set.insert(FragileCopy(inserted)));
+	FragileCopy::copiesLeft = -1;
+
+	CHECK_EQ(set.size(), static_cast<size_t>(inserted));
+	CHECK_EQ(FragileCopy::live.size(), static_cast<size_t>(inserted));
+	for(const FragileCopy& element : set)
+	{
+		CHECK(FragileCopy::live.count(&element) == 1);
+	}
+}
+
+TEST_CASE(distinctOfPartiallyOrderedTypes)
+{
+	// Equal persons are not next to each other in either order
+	std::multiset<Person, ByAge> byAge{{30, "ann"}, {30, "bob"}, {30, "ann"}};
+	CHECK_EQ(stream::of(byAge).distinct().count(), 2u);
+
+	std::multiset<Person> natural{{30, "ann"}, {30, "bob"}, {30, "ann"}};
+	CHECK_EQ(stream::of(natural).distinct().count(), 2u);
+	CHECK_EQ(stream::of(natural).sorted().distinct().count(), 2u);
+}
+
+TEST_CASE(sorted)
+{
+	std::vector<int> values{5, 3, 9, 1, 7};
+	CHECK_EQ(stream::of(values).sorted().collect<std::vector<int>>(), (std::vector<int>{1, 3, 5, 7, 9}));
+	CHECK_EQ(stream::of(values).sorted().limit<2>().collect<std::vector<int>>(), (std::vector<int>{1, 3}));
+	CHECK_EQ(stream::of(values).sorted().limit(3).collect<std::vector<int>>(), (std::vector<int>{1, 3, 5}));
+	CHECK_EQ(*stream::of(values).sorted().findFirst(), 1);
+}
+
+TEST_CASE(sortedRedoesOtherOrders)
+{
+	std::set<int, std::greater<>> descending{1, 2, 3, 4};
+	CHECK_EQ(stream::of(descending).sorted().collect<std::vector<int>>(), (std::vector<int>{1, 2, 3, 4}));
+	CHECK_EQ(stream::of(descending).sorted().limit(2).collect<std::vector<int>>(), (std::vector<int>{1, 2}));
+
+	std::set<int> ascending{4, 2, 3, 1};
+	CHECK_EQ(stream::of(ascending).sorted().collect<std::vector<int>>(), (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST_CASE(limitAndSkip)
+{
+	std::vector<int> values{1, 2, 3, 4, 5};
+	CHECK_EQ(stream::of(values).skip(1).limit(3).collect<std::vector<int>>(), (std::vector<int>{2, 3, 4}));
+	CHECK_EQ(stream::of(values).skip<10>().count(), 0u);
+	CHECK_EQ(stream::of(values).limit<0>().count(), 0u);
+}
+
+TEST_CASE(limitStopsPullingAtItsBound)
+{
+	std::vector<int> values(100, 1);
+	int tests = 0;
+
+	// The AnyStream pulls its elements through the limit
+	stream::AnyStream<int> limited = stream::of(values).filter([&](int) { ++tests; return true; }).limit<3>();
+	CHECK_EQ(limited.count(), 3u);
+	CHECK_EQ(tests, 3);
+}
+
+TEST_CASE(limitDoesNotOverPull)
+{
+	int calls = 0;
+	auto values = stream::generate([&]() { return ++calls; }).filter([](int) { return true; }).limit(3).collect<std::vector<int>>();
+
+	CHECK_EQ(values.size(), 3u);
+	CHECK_EQ(calls, 3);
+}
+
+TEST_CASE(limitStopsBeforeThePush)
+{
+	std::vector<int> values(64, 1);
+	int tests = 0;
+	auto counted = [&](int) { ++tests; return true; };
+
+	CHECK_EQ(stream::of(values).filter(counted).limit(0).count(), 0u);
+	CHECK_EQ(stream::of(values).filter(counted).limit<0>().count(), 0u);
+	CHECK_EQ(tests, 0);
+
+	CHECK_EQ(stream::of(values).batched(64).filter(counted).limit(3).count(), 3u);
+	CHECK_EQ(tests, 3);
+
+	tests = 0;
+	CHECK_EQ(stream::of(values).batched(64).filter(counted).limit<3>().collect<std::vector<int>>(), (std::vector<int>{1, 1, 1}));
+	CHECK_EQ(tests, 3);
+}
+
+TEST_CASE(flatMap)
+{
+	std::vector<std::string> lines{"a b", "", "c d e"};
+
+	auto tokens = stream::of(lines).flatMap([](const std::string& line)
+	{
+		std::vector<std::string> result;
+		std::string token;
+		for(char c : line)
+		{
+			if(c == ' ')
+			{
+				result.push_back(token);
+				token.clear();
+			}
+			else
+			{
+				token += c;
+			}
+		}
+		if(!token.empty())
+		{
+			result.push_back(token);
+		}
+		return result;
+	}).collect<std::vector<std::string>>();
+
+	CHECK_EQ(tokens, (std::vector<std::string>{"a", "b", "c", "d", "e"}));
+
+	std::vector<int> counts{1, 2, 3};
+	CHECK_EQ(stream::of(counts).flatMap([](int n) { return stream::range(0, n); }).count(), 6u);
+	CHECK_EQ(stream::of(counts).flatMap([](int n) { return stream::range(0, n); }).limit(2).collect<std::vector<int>>(), (std::vector<int>{0, 0}));
+}
+
+TEST_CASE(flatMapPullsRangesOfTheOuterElement)
+{
+	std::vector<std::string> words{"ab", "c"};
+
+	// The AnyStream pulls the elements, so the range returned is the outer element kept by the stage
+	stream::AnyStream<char> letters = stream::of(words).flatMap([](std::string& word) -> std::string& { return word; });
+	CHECK_EQ(letters.collect<std::vector<char>>(), (std::vector<char>{'a', 'b', 'c'}));
+	CHECK_EQ(words, (std::vector<std::string>{"ab", "c"}));
+}
+
+TEST_CASE(anyStream)
+{
+	std::vector<int> values{1, 2, 3, 4};
+
+	stream::AnyStream<int> evens = stream::of(values).filter([](int x) { return x % 2 == 0; });
+	stream::AnyStream<int> copy = evens;
+	CHECK_EQ(evens.collect<std::vector<int>>(), (std::vector<int>{2, 4}));
+	CHECK_EQ(copy.map([](int x) { return x * 10; }).collect<std::vector<int>>(), (std::vector<int>{20, 40}));
+
+	auto scale = std::make_unique<int>(3);
+	auto scaled = stream::of(values).map([scale = std::move(scale)](int x) { return x * *scale; });
+	static_assert(!std::is_constructible_v<stream::AnyStream<int>, decltype(scaled)>);
+	static_assert(!std::is_copy_constructible_v<stream::AnyStream<int, false>>);
+
+	stream::AnyStream<int, false> moveOnly = std::move(scaled);
+	stream::AnyStream<int, false> moved = std::move(moveOnly);
+	CHECK_EQ(moved.collect<std::vector<int>>(), (std::vector<int>{3, 6, 9, 12}));
+}
+
+TEST_CASE(chunkAndSliding)
+{
+	std::vector<int> values{1, 2, 3, 4, 5};
+
+	auto chunks = stream::of(values).chunk<2>().map([](auto chunk) { return std::vector<int>(chunk.begin(), chunk.end()); }).collect<std::vector<std::vector<int>>>();
+	CHECK_EQ(chunks, (std::vector<std::vector<int>>{{1, 2}, {3, 4}, {5}}));
+
+	auto sums = stream::of(values).sliding(3).map([](auto window) { return window[0] + window[1] + window[2]; }).collect<std::vector<int>>();
+	CHECK_EQ(sums, (std::vector<int>{6, 9, 12}));
+
+	CHECK_THROWS(std::invalid_argument, stream::of(values).sliding(0));
+}
+
+TEST_CASE(chunksOfReusablePipelinesPointIntoEachInput)
+{
+	std::vector<int> first{1, 2, 3, 4};
+	std::vector<int> second{5, 6, 7, 8, 9, 10};
+
+	auto pipeline = stream::pipeline<int>().chunk(2);
+	auto pointers = [](auto& chunks) { return chunks.map([](auto chunk) { return chunk.begin(); }).template collect<std::vector<const int*>>(); };
+
+	CHECK_EQ(pointers(pipeline.run(first)), (std::vector<const int*>{&first[0], &first[2]}));
+	CHECK_EQ(pointers(pipeline.run(second)), (std::vector<const int*>{&second[0], &second[2], &second[4]}));
+}
@@ -0,0 +1,183 @@
+#include "streams.hpp"
+#include "test.hpp"
+#include <cmath>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+	Terminal operations, collectors, sketches and statistics
+*/
+
+TEST_CASE(matching)
+{
+	std::vector<int> values{1, 2, 3, 4};
+
+	CHECK(stream::of(values).anyMatch([](int x) { return x == 3; }));
+	CHECK(!stream::of(values).allMatch([](int x) { return x < 4; }));
+	CHECK(stream::of(values).noneMatch([](int x) { return x > 4; }));
+	CHECK_EQ(*stream::of(values).filter([](int x) { return x > 1; }).findFirst(), 2);
+}
+
+TEST_CASE(countReduceMinMax)
+{
+	std::vector<int> values{3, 1, 4, 1, 5, 9, 2, 6};
+	const std::list<int> list(values.begin(), values.end());
+
+	CHECK_EQ(stream::of(values).count(), 8u);
+	CHECK_EQ(stream::of(list).filter([](int x) { return x > 2; }).count(), 5u);
+	CHECK_EQ(*stream::of(values).reduce(std::plus<int>()), 31);
+	CHECK_EQ(*stream::of(list).reduce(10, std::plus<int>()), 41);
+	CHECK_EQ(*stream::of(values).min(), 1);
+	CHECK_EQ(*stream::of(values).max(), 9);
+	CHECK_EQ(*stream::of(list).max([](int a, int b) { return b - a; }), 1);
+	CHECK_EQ(stream::of(values).average<double>(), 31.0 / 8);
+
+	std::vector<int> empty;
+	CHECK(!stream::of(empty).min().has_value());
+	CHECK(!stream::of(empty).reduce(std::plus<int>()).has_value());
+}
+
+TEST_CASE(simdKernelsMatchScalarLoops)
+{
+	std::vector<float> values;
+	for(int i = 0;i < 10000;++i)
+	{
+		values.push_back(static_cast<float>((i * 37) % 1001) - 500.0f);
+	}
+
+	float sum = 0;
+	for(float value : values)
+	{
+		sum += value;
+	}
+
+	CHECK_EQ(*stream::of(values).reduce(std::plus<float>()), sum);
+	CHECK_EQ(*stream::of(values).min(), -500.0f);
+	CHECK_EQ(*stream::of(values).max(), 500.0f);
+	CHECK_NEAR(*stream::of(values).reassociate().reduce(std::plus<float>()), sum, 1e-2);
+}
+
+TEST_CASE(boolArraysUseScalarLoops)
+{
+	bool flags[64] = {};
+	flags[17] = true;
+
+	CHECK_EQ(*stream::of(flags, 64).max(), true);
+	CHECK_EQ(*stream::of(flags, 64).min(), false);
+	CHECK_EQ(stream::of(flags, 64).filter([](bool flag) { return flag; }).count(), 1u);
+}
+
+TEST_CASE(collectIntoContainers)
+{
+	std::vector<int> values{3, 1, 3, 2};
+
+	CHECK_EQ(stream::of(values).collect<std::set<int>>(), (std::set<int>{1, 2, 3}));
+	CHECK_EQ(stream::of(values).collect<std::list<int>>().size(), 4u);
+
+	std::vector<int> existing{0};
+	stream::of(values).collect(existing);
+	CHECK_EQ(existing, (std::vector<int>{0, 3, 1, 3, 2}));
+}
+
+TEST_CASE(collectReservesTheSizeOfTheStream)
+{
+	std::vector<int> values{1, 2, 3, 4, 5, 6, 7, 8};
+
+	CHECK_EQ(stream::of(values).map([](int x) { return x * 2; }).collect<std::vector<int>>().capacity(), 8u);
+	CHECK_EQ(stream::of(values).skip<2>().limit<3>().collect<std::vector<int>>().capacity(), 3u);
+
+	// Filters only report an upper bound, which is not reserved
+	CHECK_EQ(stream::of(values).filter([](int x) { return x % 2 == 0; }).collect<std::vector<int>>().size(), 4u);
+}
+
+TEST_CASE(collectors)
+{
+	std::vector<int> values{1, 2, 3, 4, 5, 6};
+
+	CHECK_EQ(stream::of(values).collect(stream::collectors::counting()), 6u);
+	CHECK_EQ(stream::of(values).collect(stream::collectors::summing()), 21);
+	CHECK_EQ(*stream::of(values).collect(stream::collectors::averaging()), 3.5);
+	CHECK_EQ(*stream::of(values).collect(stream::collectors::maximum()), 6);
+	CHECK_EQ(*stream::of(values).collect(stream::collectors::minimum()), 1);
+
+	auto groups = stream::of(values).collect(stream::collectors::groupingBy([](int x) { return x % 3; }));
+	CHECK_EQ(groups.size(), 3u);
+	CHECK_EQ(groups[0], (std::vector<int>{3, 6}));
+
+	auto parts = stream::of(values).collect(stream::collectors::partitioningBy([](int x) { return x > 4; }));
+	CHECK_EQ(parts.first.size() + parts.second.size(), 6u);
+}
+
+TEST_CASE(sketches)
+{
+	std::vector<int> values;
+	for(int i = 0;i < 100000;++i)
+	{
+		values.push_back(i % 20000);
+	}
+
+	const size_t estimate = stream::of(values).countDistinctApprox();
+	CHECK_NEAR(static_cast<double>(estimate), 20000.0, 20000.0 * 0.05);
+
+	const size_t approx = stream::of(values).distinctApprox(1 << 20).count();
+	CHECK(approx <= 20000u);
+	CHECK(approx >= 19000u);
+}
+
+TEST_CASE(summaryStatistics)
+{
+	std::vector<int> values{3, 1, 4, 1, 5, 9, 2, 6};
+
+	auto statistics = stream::of(values).summaryStatistics();
+	CHECK_EQ(statistics.count(), 8u);
+	CHECK_EQ(statistics.sum(), 31);
+	CHECK_EQ(*statistics.min(), 1);
+	CHECK_EQ(*statistics.max(), 9);
+	CHECK_EQ(*statistics.mean(), 31.0 / 8);
+
+	double squares = 0;
+	for(int value : values)
+	{
+		squares += (value - 31.0 / 8) * (value - 31.0 / 8);
+	}
+	CHECK_NEAR(*statistics.variance(), squares / 8, 1e-12);
+	CHECK_NEAR(*statistics.sampleVariance(), squares / 7, 1e-12);
+
+	std::vector<int> large(100000, 2000000000);
+	CHECK_EQ(stream::of(large).summaryStatistics().sum(), 200000000000000LL);
+	CHECK_EQ(stream::of(large).parallel().summaryStatistics().sum(), 200000000000000LL);
+
+	std::vector<float> tenths(1000000, 0.1f);
+	CHECK_NEAR(stream::of(tenths).summaryStatistics().sum(), 1e6 * static_cast<double>(0.1f), 1e-6);
+}
+
+TEST_CASE(summaryStatisticsCompensateEachBlock)
+{
+	// Adding 1 to 1e16 rounds it away, so an uncompensated sum of the block loses the ones
+	std::vector<double> values{1e16};
+	values.insert(values.end(), 1000, 1.0);
+	values.push_back(-1e16);
+
+	CHECK_EQ(stream::of(values).summaryStatistics().sum(), 1000.0);
+	CHECK_EQ(stream::of(values).reassociate().summaryStatistics().sum(), 1000.0);
+	CHECK_NEAR(*stream::of(values).summaryStatistics().mean(), 1000.0 / 1002, 1e-12);
+}
+
+TEST_CASE(quantilesApprox)
+{
+	std::vector<double> values;
+	for(int i = 0;i < 100000;++i)
+	{
+		values.push_back(i);
+	}
+
+	auto digest = stream::of(values).quantilesApprox();
+	CHECK_EQ(*digest.quantile(0), 0);
+	CHECK_EQ(*digest.quantile(1), 99999);
+	CHECK_NEAR(*digest.quantile(0.5), 50000, 1000);
+	CHECK_NEAR(*digest.quantile(0.99), 99000, 1000);
+	CHECK(!stream::TDigest().quantile(0.5).has_value());
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+	Minimal test harness, so the tests build without any dependency. TEST_CASE(name) registers a test,
+	the CHECK macros report a failure and go on, and REQUIRE stops the test. main.cpp runs every test
+	of an executable, or those whose name contains its first argument
+*/
+namespace test
+{
+
+	struct Case
+	{
+		const char* name;
+		void (*run)();
+	};
+
+	inline std::vector<Case>& cases()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	inline size_t& failures()
+	{
+		static size_t failures = 0;
+		return failures;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* name, void (*run)())
+		{
+			cases().push_back(Case{name, run});
+		}
+	};
+
+	template<typename T, typename = void>
+	struct IsPrintable : std::false_type
+	{
+
+	};
+
+	template<typename T>
+	struct IsPrintable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>> : std::true_type
+	{
+
+	};
+
+	template<typename T>
+	std::string show(const T& value)
+	{
+		if constexpr(IsPrintable<T>::value)
+		{
+			std::ostringstream out;
+			out << value;
+			return out.str();
+		}
+		else
+		{
+			return "?";
+		}
+	}
+
+	inline void fail(const char* file, int line, const std::string& message)
+	{
+		std::cerr << file << ":" << line << ": " << message << std::endl;
+		++failures();
+	}
+
+	template<typename Actual, typename Expected>
+	bool checkEqual(const Actual& actual, const Expected& expected, const char* expression, const char* file, int line)
+	{
+		if(actual == expected)
+		{
+			return true;
+		}
+
+		fail(file, line, std::string("CHECK_EQ(") + expression + ") failed: " + show(actual) + " != " + show(expected));
+		return false;
+	}
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static const test::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	((condition) ? true : (test::fail(__FILE__, __LINE__, "CHECK(" #condition ") failed"), false))
+
+#define CHECK_EQ(actual, expected) \
+	test::checkEqual((actual), (expected), #actual ", " #expected, __FILE__, __LINE__)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+	CHECK(std::abs(static_cast<double>(actual) - static_cast<double>(expected)) <= (tolerance))
+
+#define CHECK_THROWS(Exception, ...) \
+	do \
+	{ \
+		bool thrown = false; \
+		try \
+		{ \
+			(void)(__VA_ARGS__); \
+		} \
+		catch(const Exception&) \
+		{ \
+			thrown = true; \
+		} \
+		if(!thrown) \
+		{ \
+			test::fail(__FILE__, __LINE__, "CHECK_THROWS(" #Exception ", " #__VA_ARGS__ ") failed"); \
+		} \
+	} while(false)
+
+#define REQUIRE(condition) \
+	do \
+	{ \
+		if(!CHECK(condition)) \
+		{ \
+			return; \
+		} \
+	} while(false)